@@ -0,0 +1,64 @@
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/xapplication.cpp \
+	$$PWD/xsysteminformation.cpp \
+	$$PWD/xlog.cpp \
+	$$PWD/xplaintextviewer.cpp \
+	$$PWD/xmainwindow.cpp \
+	$$PWD/xdocument.cpp \
+	$$PWD/xhighlighter.cpp \
+	$$PWD/xscrollbar.cpp \
+	$$PWD/xvaluelistmodel.cpp \
+	$$PWD/xinfopanel.cpp \
+	$$PWD/xfileprocessor.cpp \
+	$$PWD/xtreeview.cpp \
+	$$PWD/xtableview.cpp \
+	$$PWD/xtimestamppanel.cpp \
+	$$PWD/xsearchwidget.cpp \
+	$$PWD/xlinescanner.cpp \
+	$$PWD/xlineindex.cpp \
+	$$PWD/xindexcache.cpp \
+	$$PWD/xupdatecoalescer.cpp \
+	$$PWD/xbytematcher.cpp \
+	$$PWD/xmultimatcher.cpp \
+	$$PWD/xregexpprefilter.cpp \
+	$$PWD/xsearchresultlist.cpp \
+	$$PWD/xsearchresultsmodel.cpp \
+	$$PWD/xglobalsearch.cpp \
+	$$PWD/xfilterindex.cpp \
+	$$PWD/xlinebitmap.cpp \
+	$$PWD/xfilterexpression.cpp \
+	$$PWD/xfilterplan.cpp
+
+HEADERS += \
+    $$PWD/xapplication.h \
+	$$PWD/xsysteminformation.h \
+	$$PWD/xlog.h \
+	$$PWD/xplaintextviewer.h \
+	$$PWD/xmainwindow.h \
+	$$PWD/xdocument.h \
+	$$PWD/xhighlighter.h \
+	$$PWD/xscrollbar.h \
+	$$PWD/xvaluelistmodel.h \
+	$$PWD/xinfopanel.h \
+	$$PWD/xfileprocessor.h \
+	$$PWD/xtreeview.h \
+	$$PWD/xtableview.h \
+	$$PWD/xtimestamppanel.h \
+	$$PWD/xsearchwidget.h \
+	$$PWD/xlinescanner.h \
+	$$PWD/xlineindex.h \
+	$$PWD/xindexcache.h \
+	$$PWD/xspscqueue.h \
+	$$PWD/xupdatecoalescer.h \
+	$$PWD/xsegmentedvector.h \
+	$$PWD/xbytematcher.h \
+	$$PWD/xmultimatcher.h \
+	$$PWD/xregexpprefilter.h \
+	$$PWD/xsearchresultlist.h \
+	$$PWD/xsearchresultsmodel.h \
+	$$PWD/xglobalsearch.h \
+	$$PWD/xfilterindex.h \
+	$$PWD/xlinebitmap.h \
+	$$PWD/xfilterexpression.h \
+	$$PWD/xfilterplan.h
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET 	 = qlogview
+
+QT 	+= network concurrent core widgets
+
+DEFINES += QT_FATAL_WARNINGS
+
+include(./sources.pri)
+
+SOURCES += ./main.cpp
@@ -0,0 +1,104 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QTextCodec>
+
+#include "xbytematcher.h"
+
+static inline char  foldAscii(char c) {
+    return ((c >= 'A') && (c <= 'Z')) ? c + ('a' - 'A') : c;
+}
+
+xByteMatcher::xByteMatcher() {
+}
+
+xByteMatcher::xByteMatcher(const searchRequestItem & item, QTextCodec * pCodec) {
+    if ((item.type != PatternSearch) || !pCodec || !isAsciiCompatible(pCodec))
+        return;
+
+    QString pattern = item.matcher.pattern();
+    if (pattern.isEmpty() || !pCodec->canEncode(pattern))
+        return;
+
+    m_caseSensitivity = item.matcher.caseSensitivity();
+    m_matchLength     = pattern.size();
+
+    if (m_caseSensitivity == Qt::CaseInsensitive) {
+
+        // only ASCII letters are folded here, anything else goes through QString
+
+        for (const QChar & c : pattern) {
+            if (c.unicode() > 0x7F)
+                return;
+        }
+
+        m_pattern = pattern.toLatin1();
+        for (int i = 0; i < m_pattern.size(); i++) {
+            m_pattern[i] = foldAscii(m_pattern[i]);
+        }
+    }
+    else {
+        m_pattern = pCodec->fromUnicode(pattern);
+        m_matcher.setPattern(m_pattern);
+    }
+
+    m_bValid = true;
+}
+
+int     xByteMatcher::indexIn(const char * pData, int length, int from) const {
+    if (!m_bValid)
+        return -1;
+
+    if (m_caseSensitivity == Qt::CaseSensitive)
+        return m_matcher.indexIn(pData, length, from);
+
+    const int       nPattern = m_pattern.size();
+    const char *    pPattern = m_pattern.constData();
+    const char      first    = pPattern[0];
+    const char      upper    = ((first >= 'a') && (first <= 'z')) ? first - ('a' - 'A') : first;
+    const char *    pEnd     = pData + length - nPattern + 1;
+
+    for (const char * p = pData + from; p < pEnd; p++) {
+        if ((*p != first) && (*p != upper))
+            continue;
+
+        int i = 1;
+        while ((i < nPattern) && (foldAscii(p[i]) == pPattern[i])) {
+            i++;
+        }
+
+        if (i == nPattern)
+            return p - pData;
+    }
+
+    return -1;
+}
+
+bool    xByteMatcher::isAsciiCompatible(QTextCodec * pCodec) {
+    int nMib = pCodec->mibEnum();
+
+    return (nMib == 106) ||                         // UTF-8
+           (nMib == 3) ||                           // US-ASCII
+           ((nMib >= 4) && (nMib <= 13)) ||         // ISO-8859-1 .. ISO-8859-10
+           ((nMib >= 109) && (nMib <= 112)) ||      // ISO-8859-13 .. ISO-8859-16
+           ((nMib >= 2250) && (nMib <= 2258)) ||    // windows-1250 .. windows-1258
+           (nMib == 2084) || (nMib == 2088);        // KOI8-R, KOI8-U
+}
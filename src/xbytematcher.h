@@ -0,0 +1,71 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xByteMatcher_h_
+#define _xByteMatcher_h_  1
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+
+#include "xdocument.h"
+
+class QTextCodec;
+
+// plain pattern search over raw line bytes, possible only if codec is
+// ASCII compatible, so that encoded pattern can be compared byte by byte
+
+class xByteMatcher {
+public:
+
+    xByteMatcher();
+    xByteMatcher(const searchRequestItem & item, QTextCodec * pCodec);
+
+    bool        isValid() const {
+        return m_bValid;
+    }
+
+    int         matchLength() const {
+        return m_matchLength;
+    }
+
+    const QByteArray &  pattern() const {
+        return m_pattern;
+    }
+
+    Qt::CaseSensitivity caseSensitivity() const {
+        return m_caseSensitivity;
+    }
+
+    int         indexIn(const char * pData, int length, int from = 0) const;
+
+    static bool isAsciiCompatible(QTextCodec * pCodec);
+
+protected:
+
+    bool                    m_bValid        = false;
+    int                     m_matchLength   = 0;
+    Qt::CaseSensitivity     m_caseSensitivity = Qt::CaseSensitive;
+    QByteArray              m_pattern;
+    QByteArrayMatcher       m_matcher;
+};
+
+#endif
@@ -19,29 +19,75 @@
  * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
  */
 
+#include <algorithm>
+
 #include <QThread>
+#include <QTimer>
 #include <QMetaMethod>
 #include <QFileInfo>
+#include <QTextCodec>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFutureWatcher>
 
 #include "xdocument.h"
 #include "xfileprocessor.h"
+#include "xindexcache.h"
+#include "xlinescanner.h"
+#include "xupdatecoalescer.h"
+#include "xsearchresultsmodel.h"
 #include "xlog.h"
 
 xDocument::xDocument(QObject * pParent):
     QObject(pParent) {
     qCDebug(logicDocument) << "xDocument: created";
 
-    m_findResultsModel = new xValueCollection<searchResult>(this);
+    m_findResultsModel = new xSearchResultsModel(this);
     m_filtersModel = new xValueCollection<filterRule>(this);
 
     m_lineCache.setMaxCost(m_lineCacheSize);
+    m_resultCache.setMaxCost(m_resultCacheSize / m_resultCacheUnit);
     m_fileProcessor = new xFileProcessor();
     m_fileProcessor->activate();
     
     connect(m_fileProcessor, &xFileProcessor::progressChanged, this, &xDocument::progressChanged); 
-    connect(m_fileProcessor, &xFileProcessor::indexDataReady, this, &xDocument::onIndexDataReady, Qt::QueuedConnection);
-    connect(m_fileProcessor, &xFileProcessor::filterDataReady, this, &xDocument::onFilterDataReady, Qt::QueuedConnection);
-    connect(m_fileProcessor, &xFileProcessor::searchResultsReady, this, &xDocument::onSearchResultsReady, Qt::QueuedConnection);
+    connect(m_fileProcessor, &xFileProcessor::dataAvailable, this, &xDocument::onDataAvailable, Qt::QueuedConnection);
+    connect(m_fileProcessor, &xFileProcessor::filterRulesMatched, this, &xDocument::onFilterRulesMatched, Qt::QueuedConnection);
+
+    // density is computed by own worker, so it never blocks search or filter
+
+    m_densityProcessor = new xFileProcessor();
+    m_densityProcessor->activate();
+
+    connect(m_densityProcessor, &xFileProcessor::densityReady, this, &xDocument::onDensityReady, Qt::QueuedConnection);
+
+    // same for find next / previous, it is served even during indexing or search
+
+    m_findProcessor = new xFileProcessor();
+    m_findProcessor->activate();
+
+    connect(m_findProcessor, &xFileProcessor::occurrenceFound, this, &xDocument::onOccurrenceFound, Qt::QueuedConnection);
+
+    // search in all files has own worker and reports only to xGlobalSearch,
+    // find results and live search of this document stay untouched
+
+    m_globalSearchProcessor = new xFileProcessor();
+    m_globalSearchProcessor->activate();
+
+    connect(m_globalSearchProcessor, &xFileProcessor::dataAvailable, this, &xDocument::onDataAvailable, Qt::QueuedConnection);
+
+    m_checkpointsWatcher = new QFutureWatcher< QVector<quint64> >(this);
+    connect(m_checkpointsWatcher, &QFutureWatcher< QVector<quint64> >::finished, this, &xDocument::onCheckpointsReady);
+
+    m_indexCacheWatcher = new QFutureWatcher<int>(this);
+    connect(m_indexCacheWatcher, &QFutureWatcher<int>::finished, this, &xDocument::onIndexCacheLoaded);
+
+    m_updateCoalescer = new xUpdateCoalescer(m_frameInterval, this);
+    connect(m_updateCoalescer, &xUpdateCoalescer::layoutChanged, this, &xDocument::layoutChanged);
+    connect(m_updateCoalescer, &xUpdateCoalescer::linesAppended, this, &xDocument::linesAppended);
+
+    m_pendingDataTimer = new QTimer(this);
+    m_pendingDataTimer->setSingleShot(true);
+    connect(m_pendingDataTimer, &QTimer::timeout, this, &xDocument::processPendingData);
 
     connect(this, &xDocument::layoutChanged, [this]() {
         m_findResultsModel->layoutChanged();
@@ -51,7 +97,14 @@ xDocument::xDocument(QObject * pParent):
 }
 
 xDocument::~xDocument() {
+    if (m_checkpointsCancelled) {
+        *m_checkpointsCancelled = 1;
+    }
+
     m_fileProcessor->shutdown();    
+    m_densityProcessor->shutdown();
+    m_findProcessor->shutdown();
+    m_globalSearchProcessor->shutdown();
     qCDebug(logicDocument) << "xDocument: destroyed";
 }
 
@@ -63,7 +116,7 @@ QString xDocument::filePath() const {
     return m_filePath;
 }
 
-quint64             xDocument::logicalLineStart(int lineNumber, bool * bOk) const {
+quint64             xDocument::logicalLineStart(qint64 lineNumber, bool * bOk) const {
     lineNumber = logicalToSourceLineNumber(lineNumber);
 
     if ((lineNumber < 0) || (lineNumber > m_fileIndex.size() - 1)) {
@@ -73,10 +126,10 @@ quint64             xDocument::logicalLineStart(int lineNumber, bool * bOk) cons
 
     if (bOk) *bOk = true;
 
-    return m_fileIndex[lineNumber].position;
+    return m_fileIndex.position(lineNumber);
 }
 
-quint64             xDocument::logicalLineEnd(int lineNumber, bool * bOk) const {
+quint64             xDocument::logicalLineEnd(qint64 lineNumber, bool * bOk) const {
     lineNumber = logicalToSourceLineNumber(lineNumber);
 
     if ((lineNumber < 0) || (lineNumber > m_fileIndex.size() - 1)) {
@@ -86,20 +139,27 @@ quint64             xDocument::logicalLineEnd(int lineNumber, bool * bOk) const
 
     if (bOk) *bOk = true;
 
-    return m_fileIndex[lineNumber].position + m_fileIndex[lineNumber].length - 1;
+    quint64 position = 0;
+    int     length   = 0;
+    m_fileIndex.line(lineNumber, &position, &length);
+
+    return position + length - 1;
 }
 
-QByteArray     xDocument::logicalLine(int lineNumber) {
-    lineNumber = logicalToSourceLineNumber(lineNumber);
+QByteArray     xDocument::logicalLine(qint64 lineNumber) {
+    return sourceLine(logicalToSourceLineNumber(lineNumber));
+}
 
+QByteArray     xDocument::sourceLine(qint64 lineNumber) {
     if ((lineNumber < 0) || (lineNumber > m_fileIndex.size() - 1))
         return QByteArray();
 
     if (m_lineCache.contains(lineNumber))
         return *m_lineCache[lineNumber];
 
-    quint64 readFrom = m_fileIndex[lineNumber].position;
-    quint64 readCount = m_fileIndex[lineNumber].length;
+    quint64 readFrom  = 0;
+    int     readCount = 0;
+    m_fileIndex.line(lineNumber, &readFrom, &readCount);
 
     m_file.seek(readFrom);
     QByteArray * dataReaded = new QByteArray();
@@ -116,16 +176,112 @@ QByteArray           xDocument::text(quint64 from, quint64 to) {
     return dataReaded;
 }
 
-quint64 xDocument::logicalLinePosition(int lineNumber) const {
+quint64             xDocument::fileSize() const {
+    return m_fileSize;
+}
+
+quint64             xDocument::indexedSize() const {
+    return m_fileIndex.size() ? m_fileIndex.lastPosition() + m_fileIndex.lastLength() : 0;
+}
+
+bool                xDocument::isPositionIndexed(quint64 pos) const {
+    return pos < indexedSize();
+}
+
+qint64              xDocument::estimatedLineNumber(quint64 pos) const {
+    if (isPositionIndexed(pos))
+        return m_fileIndex.lineByPosition(pos);
+
+    quint64 nIndexedSize = indexedSize();
+    if (!nIndexedSize)
+        return -1;
+
+    // extrapolate average line length of indexed part
+
+    return m_fileIndex.size() + (double)(pos - nIndexedSize) * m_fileIndex.size() / nIndexedSize;
+}
+
+quint64             xDocument::resolveLineStart(quint64 pos) {
+    if (isPositionIndexed(pos))
+        return m_fileIndex.position(m_fileIndex.lineByPosition(pos));
+
+    // nearest known line start below position is either end of
+    // indexed part or closest checkpoint, look backward for newline up to it
+
+    quint64 nLowerLimit = indexedSize();
+    QVector<quint64>::const_iterator it = std::upper_bound(m_checkpoints.constBegin(), m_checkpoints.constEnd(), pos);
+    if (it != m_checkpoints.constBegin()) {
+        nLowerLimit = qMax(nLowerLimit, *(it - 1));
+    }
+
+    quint64 nReadTo = pos;
+    while (nReadTo > nLowerLimit) {
+        quint64     nReadFrom = nReadTo - qMin<quint64>(m_sparseReadSize, nReadTo - nLowerLimit);
+        QByteArray  block     = text(nReadFrom, nReadTo);
+
+        int nNewline = block.lastIndexOf('\n');
+        if (nNewline >= 0)
+            return nReadFrom + nNewline + 1;
+
+        if ((quint64)block.size() != nReadTo - nReadFrom)
+            break;
+
+        nReadTo = nReadFrom;
+    }
+
+    return nLowerLimit;
+}
+
+linesData           xDocument::resolveLines(quint64 pos, int nLines) {
+    linesData   result;
+
+    quint64 nLineStart = resolveLineStart(pos);
+    int     nReadSize  = m_sparseReadSize;
+
+    while ((result.size() < nLines) && (nLineStart < m_fileSize)) {
+        QByteArray  block = text(nLineStart, nLineStart + nReadSize);
+        if (block.isEmpty())
+            break;
+
+        const char * pBlock = block.constData();
+        const char * pEnd   = pBlock + block.size();
+        const char * pLine  = pBlock;
+        const char * pNewline;
+
+        while ((result.size() < nLines) && ((pNewline = xLineScanner::findNewline(pLine, pEnd)) != pEnd)) {
+            result << lineData{ nLineStart + (pLine - pBlock), (int)(pNewline - pLine + 1) };
+            pLine = pNewline + 1;
+        }
+
+        if (block.size() < nReadSize) {
+            if ((result.size() < nLines) && (pLine < pEnd)) {
+                result << lineData{ nLineStart + (pLine - pBlock), (int)(pEnd - pLine) };
+            }
+            break;
+        }
+
+        if (pLine == pBlock) {
+            nReadSize *= 2;
+            continue;
+        }
+
+        nLineStart += pLine - pBlock;
+        nReadSize   = m_sparseReadSize;
+    }
+
+    return result;
+}
+
+quint64 xDocument::logicalLinePosition(qint64 lineNumber) const {
     lineNumber = logicalToSourceLineNumber(lineNumber);
 
     if ((lineNumber < 0) || (lineNumber >= m_fileIndex.size()))
         return 0;
 
-     return m_fileIndex[lineNumber].position;
+     return m_fileIndex.position(lineNumber);
 }
 
-QByteArray          xDocument::logicalLinesAsText(int fromLine, int toLine) {
+QByteArray          xDocument::logicalLinesAsText(qint64 fromLine, qint64 toLine) {
     QByteArray   result;
 
     fromLine = fromLine < 0 ? 0 : fromLine;
@@ -134,14 +290,14 @@ QByteArray          xDocument::logicalLinesAsText(int fromLine, int toLine) {
     toLine = toLine < 0 ? 0 : toLine;
     toLine = toLine > (logicalLinesCount() - 1) ? logicalLinesCount() - 1 : toLine;
 
-    for (int i = fromLine; i <= toLine; i++) {
+    for (qint64 i = fromLine; i <= toLine; i++) {
         result.append(logicalLine(i));
     }
 
     return result;
 }
 
-QVector<QByteArray> xDocument::logicalLines(int from, int to) {
+QVector<QByteArray> xDocument::logicalLines(qint64 from, qint64 to) {
     QVector<QByteArray>     result;
 
     from = from < 0 ? 0 : from;
@@ -150,40 +306,29 @@ QVector<QByteArray> xDocument::logicalLines(int from, int to) {
     to = to < 0 ? 0 : to;
     to = to > (logicalLinesCount() - 1) ? logicalLinesCount() - 1 : to;
 
-    for (int i = from; i <= to; i++) {
+    for (qint64 i = from; i <= to; i++) {
         result << logicalLine(i);
     }
 
     return result;
 }
 
-int                 xDocument::logicalLineByPosition(quint64 pos) const {
-
-    QVector<lineData>::const_iterator   it = std::upper_bound(m_fileIndex.begin(), m_fileIndex.end(), pos, [](quint64 pos, const lineData & item) {
-        return pos < (item.position + item.length);
-    });
+qint64              xDocument::logicalLineByPosition(quint64 pos) const {
 
-    if (it == m_fileIndex.end())
+    qint64 nLineIndex = m_fileIndex.lineByPosition(pos);
+    if (nLineIndex < 0)
         return -1;
 
-    int nLineIndex = std::distance(m_fileIndex.begin(), it) - 1;
-    if (nLineIndex < 0) nLineIndex = 0;
-
     if (m_bFilterActive) {
-        QMap<int, int>::const_iterator  indexIterator = m_filterIndex.forwardIndex.find(nLineIndex);
-        if (indexIterator == m_filterIndex.forwardIndex.end()) {
-            return -1;
-        }
-
-        nLineIndex = indexIterator.value();
+        nLineIndex = m_filterIndex.filteredLine(nLineIndex);
     }
 
     return nLineIndex;
 }
 
-int                 xDocument::logicalLinesBetweenPositions(quint64 start, quint64 stop) const {
-    int lineStart = logicalLineByPosition(start);
-    int lineEnd   = logicalLineByPosition(stop);
+qint64              xDocument::logicalLinesBetweenPositions(quint64 start, quint64 stop) const {
+    qint64 lineStart = logicalLineByPosition(start);
+    qint64 lineEnd   = logicalLineByPosition(stop);
 
     if (lineStart == -1 || lineEnd == -1)
         return -1;
@@ -194,54 +339,258 @@ int                 xDocument::logicalLinesBetweenPositions(quint64 start, quint
 void        xDocument::invalidate() {
     emit    message(tr("Loading file..."));
 
-    emit    layoutChanged();
+    m_updateCoalescer->requestLayout();
 
     if (m_file.isOpen()) {
         m_file.close();
     }
 
     m_fileProcessor->interrupt();
+    m_findProcessor->interrupt();
+    cancelGlobalSearch();
+    m_fileProcessor->indexQueue()->clear();
+    m_fileProcessor->searchQueue()->clear();
+    m_fileProcessor->filterQueue()->clear();
+    m_bSearching = false;
+    m_pendingSearchKey.clear();
+    m_pendingFilterKey.clear();
+    m_pendingRuleKeys.clear();
+    m_generation++;
     m_file.setFileName(m_filePath);
     m_file.open(QIODevice::ReadOnly);
     setFilterRulesEnabled(false);
-    m_filterIndex = documentIndex();
+    m_filterIndex.clear();
+    m_filterCoveredSize = 0;
+    stopLiveFilter();
+    stopLiveSearch();
     m_fileIndex.clear();
+    m_lineCache.clear();
+    m_checkpoints.clear();
+    m_fileSize = m_file.size();
+
+    if (m_checkpointsCancelled) {
+        *m_checkpointsCancelled = 1;
+        m_checkpointsCancelled.reset();
+    }
+
+    // index cache is hashed and read on worker, so opening large file
+    // does not block; document is indexing until it is loaded
+
+    QString                     filePath = m_filePath;
+    QSharedPointer<xLineIndex>  loaded(new xLineIndex());
+
+    m_bIndexing      = true;
+    m_indexCacheLoad = loaded;
+    m_indexCacheWatcher->setFuture(QtConcurrent::run([filePath, loaded]() {
+        return (int)xIndexCache::load(filePath, loaded.data());
+    }));
+}
+
+void        xDocument::onIndexCacheLoaded() {
+    // result loaded for previously opened file is dropped
+
+    if (!m_indexCacheLoad)
+        return;
+
+    xIndexCache::cacheState cacheState = (xIndexCache::cacheState)m_indexCacheWatcher->result();
+
+    m_fileIndex = *m_indexCacheLoad;
+    m_indexCacheLoad.reset();
+    m_lineCache.clear();
+
+    // density is started only once file is indexed, so it does not
+    // compete with the first scan for disk
+
+    m_bIndexing = (cacheState != xIndexCache::cacheValid);
+
+    restartDensity();
+
+    if (cacheState == xIndexCache::cacheValid) {
+        m_updateCoalescer->requestLayout();
+        emit message(tr("Document ready"), 3000);
+        return;
+    }
+
+    if (cacheState == xIndexCache::cacheAppended) {
+        m_updateCoalescer->requestLayout();
+    }
+
+    quint64 nCheckpointStride = qMax<quint64>(m_checkpointMinStride, m_fileSize / m_checkpointMaxCount);
+    if (m_fileSize > nCheckpointStride) {
+        QString                     filePath   = m_filePath;
+        QSharedPointer<QAtomicInt>  cancelled(new QAtomicInt(0));
+
+        m_checkpointsCancelled = cancelled;
+        m_checkpointsWatcher->setFuture(QtConcurrent::run([filePath, nCheckpointStride, cancelled]() {
+            return xFileProcessor::createCheckpoints(filePath, nCheckpointStride, *cancelled);
+        }));
+    }
+
+    continueIndex();
+}
+
+void        xDocument::continueIndex() {
+    // indexing goes on from end of cached index once it is loaded
+
+    if (m_indexCacheLoad)
+        return;
 
     static int          methodIndex = -1;
     static QMetaMethod  method;
 
     if (methodIndex == -1) {
-        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("createIndex(QString,int,int)");
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("createIndex(QString,quint64,int,int)");
         method = m_fileProcessor->metaObject()->method(methodIndex);
     }
 
     method.invoke(m_fileProcessor, Qt::QueuedConnection,
         Q_ARG(QString, m_filePath),
+        Q_ARG(quint64, (m_fileIndex.size() ? m_fileIndex.lastPosition() : 0)),
         Q_ARG(int, m_notifyPerLine),
         Q_ARG(int, m_blockSize));
 }
 
-int xDocument::logicalLinesCount() const
+bool        xDocument::interruptProcessor() {
+    if (!m_fileProcessor->isBusy())
+        return false;
+
+    m_fileProcessor->interrupt();
+
+    if (!m_bIndexing)
+        return false;
+
+    // initial indexing was interrupted by another request, lines posted so far
+    // are taken at once and indexing is queued again from the last known line
+    // ahead of anything the caller is going to queue
+
+    m_fileProcessor->indexQueue()->acknowledge();
+
+    indexBatch  index;
+    while (m_fileProcessor->indexQueue()->pop(index)) {
+        onIndexDataReady(std::move(index.data), index.bCompleted);
+    }
+
+    if (m_bIndexing) {
+        continueIndex();
+    }
+
+    return true;
+}
+
+qint64 xDocument::logicalLinesCount() const
 {
-    return m_bFilterActive ? m_filterIndex.forwardIndex.size() : m_fileIndex.size();
+    return m_bFilterActive ? m_filterIndex.size() : m_fileIndex.size();
 }
 
-void                xDocument::search(const searchRequestItem &  requestItem, const QByteArray & encoding, bool bStore, quint64 startPosition, int maxOccurencies) {
+bool                xDocument::search(const searchRequestItem &  requestItem, const QByteArray & encoding, bool bStore, quint64 startPosition, int maxOccurencies) {
     if (m_fileProcessor->isBusy())
-        return;
+        return false;
 
-    emit message(tr("Searching..."));
+    stopLiveSearch();
 
     m_findResultsModel->clear();
+    m_fileProcessor->searchQueue()->clear();
+    m_searchEncoding = encoding;
+    m_liveSearchItem = requestItem;
+    m_bSearching     = true;
     if (bStore) {
         m_filtersModel->appendItem(filterRule{ requestItem, false });
     }
 
+    // repeated request is served from cache, if file has grown since then
+    // cached part is shown at once and only the rest of file is scanned
+
+    searchRange         from{ startPosition, qMax<qint64>(0, m_fileIndex.lineByPosition(startPosition)) };
+    xSearchResultList   cached;
+
+    m_pendingSearchKey.clear();
+
+    if (startPosition == 0) {
+        QString         key     = searchCacheKey(requestItem, encoding);
+        cachedResult *  pCached = m_resultCache.object(key);
+
+        if (pCached && pCached->results && (pCached->fileSize <= m_fileSize)) {
+            countCacheLookup(true);
+            cached = *pCached->results;
+
+            if (pCached->fileSize == m_fileSize) {
+                if ((maxOccurencies > 0) && (cached.size() > maxOccurencies)) {
+                    cached.truncate(maxOccurencies);
+                }
+
+                m_findResultsModel->setResults(cached);
+                m_bSearching = false;
+
+                if ((maxOccurencies == 0) || (cached.size() < maxOccurencies)) {
+                    startLiveSearch(resumePoint().position);
+                }
+
+                emit message(tr("Search completed, %1 results found (cached)").arg(cached.size()));
+                return true;
+            }
+
+            from = pCached->resumeFrom;
+            cached.truncate(cached.lowerBound(from.position));
+        }
+        else {
+            countCacheLookup(false);
+        }
+
+        m_pendingSearchKey              = key;
+        m_pendingSearch                 = cachedResult();
+        m_pendingSearch.resumeFrom      = resumePoint();
+        m_pendingSearch.fileSize        = m_fileSize;
+        m_pendingSearchLimit            = maxOccurencies;
+    }
+
+    if (!cached.isEmpty()) {
+        if ((maxOccurencies > 0) && (cached.size() >= maxOccurencies)) {
+            cached.truncate(maxOccurencies);
+
+            m_findResultsModel->setResults(cached);
+            m_bSearching = false;
+            m_pendingSearchKey.clear();
+
+            emit message(tr("Search completed, %1 results found (cached)").arg(cached.size()));
+            return true;
+        }
+
+        m_findResultsModel->setResults(cached);
+
+        if (maxOccurencies > 0) {
+            maxOccurencies -= cached.size();
+        }
+    }
+
+    emit message(tr("Searching..."));
+
+    searchRanges    ranges = parallelSearchRanges();
+
+    if ((from.position == 0) && (ranges.size() > 1)) {
+        static int          parallelMethodIndex = -1;
+        static QMetaMethod  parallelMethod;
+
+        if (parallelMethodIndex == -1) {
+            parallelMethodIndex = m_fileProcessor->metaObject()->indexOfMethod("searchDataParallel(QString,QByteArray,searchRequestItem,searchRanges,int,int,int)");
+            parallelMethod = m_fileProcessor->metaObject()->method(parallelMethodIndex);
+        }
+
+        parallelMethod.invoke(m_fileProcessor, Qt::QueuedConnection,
+            Q_ARG(QString, m_filePath),
+            Q_ARG(QByteArray, encoding),
+            Q_ARG(searchRequestItem, requestItem),
+            Q_ARG(searchRanges, ranges),
+            Q_ARG(int, maxOccurencies),
+            Q_ARG(int, m_notifyPerLine),
+            Q_ARG(int, m_blockSize));
+        return true;
+    }
+
     static int          methodIndex = -1;
     static QMetaMethod  method;
 
     if (methodIndex == -1) {
-        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("searchData(QString,QByteArray,searchRequestItem,quint64,int,int,int)");
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("searchData(QString,QByteArray,searchRequestItem,searchRange,int,int,int)");
         method = m_fileProcessor->metaObject()->method(methodIndex);
     }
 
@@ -249,33 +598,384 @@ void                xDocument::search(const searchRequestItem &  requestItem, co
         Q_ARG(QString, m_filePath),
         Q_ARG(QByteArray, encoding),
         Q_ARG(searchRequestItem, requestItem),
-        Q_ARG(quint64, startPosition),
+        Q_ARG(searchRange, from),
         Q_ARG(int, maxOccurencies),
         Q_ARG(int, m_notifyPerLine),
         Q_ARG(int, m_blockSize));
+
+    return true;
+}
+
+void                xDocument::cancelSearch() {
+    if (!m_bSearching)
+        return;
+
+    interruptProcessor();
+
+    m_fileProcessor->searchQueue()->clear();
+    m_bSearching = false;
+    m_pendingSearchKey.clear();
+    stopLiveSearch();
+
+    emit message(tr("Search cancelled, %1 results found").arg(m_findResultsModel->results().size()), 3000);
+}
+
+bool                xDocument::isSearching() const {
+    return m_bSearching;
+}
+
+bool                xDocument::startGlobalSearch(const searchRequestItem & requestItem, const QByteArray & encoding, int maxOccurencies) {
+    if (!m_file.isOpen())
+        return false;
+
+    if (m_globalSearchProcessor->isBusy()) {
+        m_globalSearchProcessor->interrupt();
+    }
+
+    m_globalSearchProcessor->searchQueue()->clear();
+    m_bGlobalSearching = true;
+
+    searchRanges    ranges = parallelSearchRanges();
+
+    if (ranges.size() > 1) {
+        static int          parallelMethodIndex = -1;
+        static QMetaMethod  parallelMethod;
+
+        if (parallelMethodIndex == -1) {
+            parallelMethodIndex = m_globalSearchProcessor->metaObject()->indexOfMethod("searchDataParallel(QString,QByteArray,searchRequestItem,searchRanges,int,int,int)");
+            parallelMethod = m_globalSearchProcessor->metaObject()->method(parallelMethodIndex);
+        }
+
+        parallelMethod.invoke(m_globalSearchProcessor, Qt::QueuedConnection,
+            Q_ARG(QString, m_filePath),
+            Q_ARG(QByteArray, encoding),
+            Q_ARG(searchRequestItem, requestItem),
+            Q_ARG(searchRanges, ranges),
+            Q_ARG(int, maxOccurencies),
+            Q_ARG(int, m_notifyPerLine),
+            Q_ARG(int, m_blockSize));
+        return true;
+    }
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_globalSearchProcessor->metaObject()->indexOfMethod("searchData(QString,QByteArray,searchRequestItem,searchRange,int,int,int)");
+        method = m_globalSearchProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_globalSearchProcessor, Qt::QueuedConnection,
+        Q_ARG(QString, m_filePath),
+        Q_ARG(QByteArray, encoding),
+        Q_ARG(searchRequestItem, requestItem),
+        Q_ARG(searchRange, searchRange()),
+        Q_ARG(int, maxOccurencies),
+        Q_ARG(int, m_notifyPerLine),
+        Q_ARG(int, m_blockSize));
+
+    return true;
+}
+
+void                xDocument::cancelGlobalSearch() {
+    if (m_globalSearchProcessor->isBusy()) {
+        m_globalSearchProcessor->interrupt();
+    }
+
+    m_globalSearchProcessor->searchQueue()->clear();
+
+    // caller waiting for this document is released
+
+    if (m_bGlobalSearching) {
+        m_bGlobalSearching = false;
+        emit globalSearchResultsReady(searchResults(), true);
+    }
+}
+
+searchRanges        xDocument::parallelSearchRanges() const {
+    searchRanges    ranges;
+
+    // ranges are cut on line starts known from index, so it is possible
+    // only when file is completely indexed
+
+    int nWorkers = m_fileProcessor->indexWorkers();
+    if (m_bIndexing || !m_fileIndex.size() || (nWorkers < 2) || (m_fileSize < m_parallelSearchThreshold))
+        return ranges;
+
+    quint64 nChunkSize = qBound<quint64>(m_searchChunkMinSize, m_fileSize / (nWorkers * 8), m_searchChunkMaxSize);
+
+    ranges << searchRange{ 0, 0 };
+
+    for (quint64 nPosition = nChunkSize; nPosition < m_fileSize; nPosition += nChunkSize) {
+        qint64 nLine = m_fileIndex.lowerBound(nPosition);
+        if (nLine >= m_fileIndex.size())
+            break;
+
+        quint64 nLineStart = m_fileIndex.position(nLine);
+        if (nLineStart > ranges.last().position) {
+            ranges << searchRange{ nLineStart, nLine };
+        }
+    }
+
+    return ranges;
+}
+
+void                xDocument::findOccurrence(const searchRequestItem & requestItem, const QByteArray & encoding, quint64 position, bool bBackward) {
+    // previous find is abandoned, interrupted find reports nothing
+
+    if (m_findProcessor->isBusy()) {
+        m_findProcessor->interrupt();
+    }
+
+    emit message(bBackward ? tr("Searching previous occurrence...") : tr("Searching next occurrence..."));
+
+    // lines hidden by active filter are passed over, so find never leaves
+    // filtered view
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_findProcessor->metaObject()->indexOfMethod("findOccurrence(QString,QByteArray,searchRequestItem,filterRules,quint64,bool,int)");
+        method = m_findProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_findProcessor, Qt::QueuedConnection,
+        Q_ARG(QString, m_filePath),
+        Q_ARG(QByteArray, encoding),
+        Q_ARG(searchRequestItem, requestItem),
+        Q_ARG(filterRules, (m_bFilterActive ? m_liveFilterRules : filterRules())),
+        Q_ARG(quint64, position),
+        Q_ARG(bool, bBackward),
+        Q_ARG(int, m_blockSize));
 }
 
 void                xDocument::filter(const filterRules & rules, const QByteArray & encoding, bool bSetActive) {
-    if (m_fileProcessor->isBusy()) {
-        m_fileProcessor->interrupt();
+    interruptProcessor();
+
+    if (m_bSearching) {
+        m_fileProcessor->searchQueue()->clear();
+        m_bSearching = false;
+        m_pendingSearchKey.clear();
+    }
+
+    m_fileProcessor->filterQueue()->clear();
+
+    // complete result of previous filter is kept, it may be narrowed
+    // instead of scanning whole file again
+
+    xFilterIndex    previous;
+    QStringList     previousKeys;
+
+    if (m_filterCoveredSize && (m_filterCoveredSize == m_fileSize)) {
+        previous     = m_filterIndex;
+        previousKeys = m_filterRuleKeys;
     }
 
     resetFilter();
 
+    m_liveFilterRules    = rules;
+    m_liveFilterEncoding = encoding;
+
+    m_filterRuleKeys.clear();
+    for (const filterRule & rule : rules) {
+        if (rule.isActive)
+            m_filterRuleKeys << ruleCacheKey(rule.filter, encoding);
+    }
+
+    m_filterRequestId++;
+    m_pendingRuleKeys.clear();
+    m_bFilterKnown = false;
+    m_filterKnown.clear();
+
+    QString         key     = filterCacheKey(rules, encoding);
+    cachedResult *  pCached = m_resultCache.object(key);
+    searchRange     from;
+    filterRules     evaluated;
+
+    if (pCached && (pCached->fileSize <= m_fileSize)) {
+        countCacheLookup(true);
+        m_filterIndex = pCached->index;
+
+        if (pCached->fileSize == m_fileSize) {
+            m_pendingFilterKey.clear();
+            m_filterCoveredSize = m_fileSize;
+            startLiveFilter(resumePoint().position);
+            setFilterRulesEnabled(bSetActive);
+            m_updateCoalescer->requestLayout();
+
+            emit message(tr("Filter ready, %1 lines found (cached)").arg(m_filterIndex.size()));
+            return;
+        }
+
+        // lines from resume point are scanned again
+
+        from = pCached->resumeFrom;
+        m_filterIndex.truncate(from.lineNumber);
+
+        for (const filterRule & rule : rules) {
+            if (rule.isActive)
+                evaluated << rule;
+        }
+    }
+    else {
+        // rules evaluated before for this file are taken from their own
+        // bitmaps, only the rest is left for worker; bitmap made before file
+        // has grown is kept for lines before its resume point
+
+        QVector<const cachedResult *>   known;
+        QVector<const cachedResult *>   stale;
+        filterRules                     unknown;
+        filterRules                     extended;
+
+        for (const filterRule & rule : rules) {
+            if (!rule.isActive)
+                continue;
+
+            const cachedResult * pRule = m_resultCache.object(ruleCacheKey(rule.filter, encoding));
+            if (pRule && (pRule->fileSize == m_fileSize)) {
+                known << pRule;
+            }
+            else if (pRule && (pRule->fileSize < m_fileSize)) {
+                stale    << pRule;
+                extended << rule;
+            }
+            else {
+                unknown << rule;
+            }
+        }
+
+        evaluated = unknown + extended;
+
+        // every rule is known up to some point, so only the part after
+        // earliest resume point is scanned for grown ones
+
+        if (unknown.isEmpty() && !stale.isEmpty()) {
+            from = stale.first()->resumeFrom;
+            for (const cachedResult * pRule : stale) {
+                if (pRule->resumeFrom.lineNumber < from.lineNumber)
+                    from = pRule->resumeFrom;
+            }
+
+            xLineBitmap prefix = stale.first()->lines;
+            for (int i = 1; i < stale.size(); i++) {
+                prefix.intersect(stale.at(i)->lines);
+            }
+            for (const cachedResult * pRule : known) {
+                prefix.intersect(pRule->lines);
+            }
+            prefix.truncate(from.lineNumber);
+            prefix.forEach([this](qint64 line) {
+                m_filterIndex.append(line);
+            });
+        }
+
+        if (!known.isEmpty()) {
+            m_filterKnown = known.first()->lines;
+            for (int i = 1; i < known.size(); i++) {
+                m_filterKnown.intersect(known.at(i)->lines);
+            }
+            m_bFilterKnown = true;
+        }
+
+        if (evaluated.isEmpty() && m_bFilterKnown) {
+            countCacheLookup(true);
+            m_filterKnown.forEach([this](qint64 line) {
+                m_filterIndex.append(line);
+            });
+            finishFilter(key, bSetActive);
+            return;
+        }
+
+        // every rule of previous filter is still active, so only lines it
+        // has passed are checked against the rest, worth it while they are
+        // small part of file
+
+        bool bNarrow = !unknown.isEmpty() && !previousKeys.isEmpty() && (previous.size() <= m_fileIndex.size() / m_narrowFilterRatio);
+        for (const QString & ruleKey : previousKeys) {
+            bNarrow = bNarrow && m_filterRuleKeys.contains(ruleKey);
+        }
+
+        if (bNarrow) {
+            filterRules     narrowing;
+
+            for (const filterRule & rule : evaluated) {
+                if (!previousKeys.contains(ruleCacheKey(rule.filter, encoding)))
+                    narrowing << rule;
+            }
+
+            if (narrowing.isEmpty()) {
+                for (qint64 i = 0; i < previous.size(); i++) {
+                    qint64 nLine = previous.sourceLine(i);
+                    if (!m_bFilterKnown || m_filterKnown.contains(nLine))
+                        m_filterIndex.append(nLine);
+                }
+
+                countCacheLookup(true);
+                finishFilter(key, bSetActive);
+                return;
+            }
+
+            countCacheLookup(false);
+
+            m_pendingFilterKey          = key;
+            m_pendingFilter             = cachedResult();
+            m_pendingFilter.resumeFrom  = resumePoint();
+            m_pendingFilter.fileSize    = m_fileSize;
+
+            emit message(tr("Narrowing current filter..."));
+
+            static int          methodIndex = -1;
+            static QMetaMethod  method;
+
+            if (methodIndex == -1) {
+                methodIndex = m_fileProcessor->metaObject()->indexOfMethod("narrowFilter(QString,QByteArray,filterRules,xFilterIndex,xLineIndex,int,int)");
+                method = m_fileProcessor->metaObject()->method(methodIndex);
+            }
+
+            method.invoke(m_fileProcessor, Qt::QueuedConnection,
+                Q_ARG(QString, m_filePath),
+                Q_ARG(QByteArray, encoding),
+                Q_ARG(filterRules, narrowing),
+                Q_ARG(xFilterIndex, previous),
+                Q_ARG(xLineIndex, m_fileIndex),
+                Q_ARG(int, m_notifyPerLine),
+                Q_ARG(int, m_blockSize));
+
+            setFilterRulesEnabled(bSetActive);
+            return;
+        }
+
+        countCacheLookup(false);
+    }
+
+    m_pendingFilterKey          = key;
+    m_pendingFilter             = cachedResult();
+    m_pendingFilter.resumeFrom  = resumePoint();
+    m_pendingFilter.fileSize    = m_fileSize;
+
+    for (const filterRule & rule : evaluated) {
+        m_pendingRuleKeys << ruleCacheKey(rule.filter, encoding);
+    }
+    m_pendingRulesFrom  = from;
+    m_pendingRules      = m_pendingFilter;
+
     emit message(tr("Applying selected filter..."));
     
     static int          methodIndex = -1;
     static QMetaMethod  method;
 
     if (methodIndex == -1) {
-        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("createFilter(QString,QByteArray,filterRules,int,int)");
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("createFilter(QString,QByteArray,filterRules,searchRange,int,int,int)");
         method = m_fileProcessor->metaObject()->method(methodIndex);
     }
 
     method.invoke(m_fileProcessor, Qt::QueuedConnection,
         Q_ARG(QString, m_filePath),
         Q_ARG(QByteArray, encoding),
-        Q_ARG(filterRules, rules),
+        Q_ARG(filterRules, evaluated),
+        Q_ARG(searchRange, from),
+        Q_ARG(int, m_filterRequestId),
         Q_ARG(int, m_notifyPerLine),
         Q_ARG(int, m_blockSize));
 
@@ -300,7 +1000,7 @@ void                xDocument::setAutoRefresh(bool b) {
 
         method.invoke(m_fileProcessor, Qt::QueuedConnection,
             Q_ARG(QString, m_filePath),
-            Q_ARG(lineData, (m_fileIndex.size() ? m_fileIndex.last() : lineData{0,0})),
+            Q_ARG(lineData, (m_fileIndex.size() ? lineData{ m_fileIndex.lastPosition(), m_fileIndex.lastLength() } : lineData{0,0})),
             Q_ARG(int, 1000));
     }
     else {
@@ -318,78 +1018,582 @@ void                xDocument::setAutoRefresh(bool b) {
     }
 }
 
+void                xDocument::finishFilter(const QString & key, bool bSetActive) {
+    m_bFilterKnown = false;
+    m_filterKnown.clear();
+
+    cachedResult result;
+    result.index      = m_filterIndex;
+    result.resumeFrom = resumePoint();
+    result.fileSize   = m_fileSize;
+    storeCachedResult(key, result, m_filterIndex.memoryUsage());
+
+    m_pendingFilterKey.clear();
+    m_filterCoveredSize = m_fileSize;
+    startLiveFilter(resumePoint().position);
+    setFilterRulesEnabled(bSetActive);
+    m_updateCoalescer->requestLayout();
+
+    emit message(tr("Filter ready, %1 lines found").arg(m_filterIndex.size()));
+}
+
 void                xDocument::resetFilter() {
     m_bFilterActive = false;
-    m_filterIndex.forwardIndex.clear();
-    m_filterIndex.reverseIndex.clear();
-    emit layoutChanged();
+    m_filterIndex.clear();
+    m_filterCoveredSize = 0;
+    stopLiveFilter();
+    m_updateCoalescer->requestLayout();
 }
 
 void                xDocument::setFilterRulesEnabled(bool bEnabled) {
     if (m_bFilterActive != bEnabled) {
         m_bFilterActive = bEnabled;
-        emit layoutChanged();
+        m_updateCoalescer->requestLayout();
+    }
+}
+
+void        xDocument::onDataAvailable() {
+    if (m_pendingDataTimer->isActive())
+        return;
+
+    // worker may produce data much faster than screen is able to show it,
+    // so pending data is picked up not more than once per frame
+
+    qint64 nElapsed = m_pendingDataElapsed.isValid() ? m_pendingDataElapsed.elapsed() : m_frameInterval;
+    m_pendingDataTimer->start(qMax<qint64>(0, m_frameInterval - nElapsed));
+}
+
+void        xDocument::processPendingData() {
+    m_pendingDataElapsed.start();
+
+    m_fileProcessor->indexQueue()->acknowledge();
+    m_fileProcessor->filterQueue()->acknowledge();
+    m_fileProcessor->searchQueue()->acknowledge();
+
+    indexBatch  index;
+    while (m_fileProcessor->indexQueue()->pop(index)) {
+        onIndexDataReady(std::move(index.data), index.bCompleted);
+        onLiveMatchesReady(index.filterRulesId, index.filterMatches, index.searchRulesId, index.searchMatches);
+    }
+
+    filterBatch filter;
+    while (m_fileProcessor->filterQueue()->pop(filter)) {
+        onFilterDataReady(std::move(filter.data), filter.bCompleted);
+    }
+
+    searchBatch search;
+    while (m_fileProcessor->searchQueue()->pop(search)) {
+        onSearchResultsReady(std::move(search.data), search.bCompleted);
+    }
+
+    m_globalSearchProcessor->searchQueue()->acknowledge();
+
+    while (m_globalSearchProcessor->searchQueue()->pop(search)) {
+        if (!m_bGlobalSearching)
+            continue;
+
+        m_bGlobalSearching = !search.bCompleted;
+        emit globalSearchResultsReady(search.data, search.bCompleted);
     }
 }
 
 void        xDocument::onSearchResultsReady(searchResults results, bool bCompleted) {
+    if (!m_bSearching)
+        return;
+
     m_findResultsModel->appendItems(results);    
+
+    // result which would not fit cache anyway is not going to be stored
+
+    if (!m_pendingSearchKey.isEmpty() && ((qint64)m_findResultsModel->memoryUsage() > m_resultCacheSize)) {
+        m_pendingSearchKey.clear();
+    }
+
     if (bCompleted) {
-        emit message(tr("Search completed, %1 results found").arg(m_findResultsModel->rowCount()));
+        m_bSearching = false;
+        emit message(tr("Search completed, %1 results found").arg(m_findResultsModel->results().size()));
+
+        // search stopped by limit has not seen whole file, so it is not cached,
+        // stored is compact copy sharing storage with find results model
+
+        if (!m_pendingSearchKey.isEmpty() && ((m_pendingSearchLimit == 0) || (m_findResultsModel->results().size() < m_pendingSearchLimit))) {
+            m_pendingSearch.results = QSharedPointer<const xSearchResultList>(new xSearchResultList(m_findResultsModel->results()));
+            storeCachedResult(m_pendingSearchKey, m_pendingSearch, m_findResultsModel->memoryUsage());
+            startLiveSearch(m_pendingSearch.resumeFrom.position);
+        }
+        m_pendingSearchKey.clear();
+        m_pendingSearch = cachedResult();
     }
 }
 
-void        xDocument::onFilterDataReady(documentIndex  data, bool bCompleted) {  
-    {
-        QMapIterator<int, int>   it(data.forwardIndex);
-        while (it.hasNext()) { it.next();  m_filterIndex.forwardIndex[it.key()] = it.value(); };
+void        xDocument::onFilterDataReady(filterLines data, bool bCompleted) {  
+    qint64 nFirstLine = m_filterIndex.size();
+
+    // worker reads file front to back, so batch only extends filter index
+
+    for (qint64 nLine : data) {
+        if (!m_bFilterKnown || m_filterKnown.contains(nLine))
+            m_filterIndex.append(nLine);
     }
-    {
-        QMapIterator<int, int>   it(data.reverseIndex);
-        while (it.hasNext()) { it.next(); m_filterIndex.reverseIndex[it.key()] = it.value(); };
+
+    if (m_bFilterActive) {
+        m_updateCoalescer->requestAppend(nFirstLine, m_filterIndex.size() - nFirstLine);
     }
 
     if (bCompleted) {
-        emit message(tr("Filter ready, %1 lines found").arg(m_filterIndex.forwardIndex.size()));
+        emit message(tr("Filter ready, %1 lines found").arg(m_filterIndex.size()));
+        m_updateCoalescer->requestLayout();
+
+        m_bFilterKnown = false;
+        m_filterKnown.clear();
+
+        if (!m_pendingFilterKey.isEmpty()) {
+            m_filterCoveredSize   = m_pendingFilter.fileSize;
+            startLiveFilter(m_pendingFilter.resumeFrom.position);
+            m_pendingFilter.index = m_filterIndex;
+            storeCachedResult(m_pendingFilterKey, m_pendingFilter, m_filterIndex.memoryUsage());
+            m_pendingFilterKey.clear();
+            m_pendingFilter = cachedResult();
+        }
+    }
+}
+
+void        xDocument::onFilterRulesMatched(int requestId, QVector<xLineBitmap> matches, QVector<bool> complete) {
+    if ((requestId != m_filterRequestId) || (matches.size() != m_pendingRuleKeys.size()))
+        return;
+
+    // scan started from resume point extends bitmap kept for earlier part
+    // of file, it is dropped if it does not reach that point; rules not
+    // evaluated on every line are not known and stay out of cache
+
+    for (int i = 0; i < matches.size(); i++) {
+        if (!complete.value(i))
+            continue;
+
+        cachedResult result = m_pendingRules;
+        result.lines        = matches.at(i);
+
+        if (m_pendingRulesFrom.lineNumber) {
+            const cachedResult * pCached = m_resultCache.object(m_pendingRuleKeys.at(i));
+            if (!pCached || (pCached->resumeFrom.lineNumber < m_pendingRulesFrom.lineNumber))
+                continue;
+
+            result.lines = pCached->lines;
+            result.lines.truncate(m_pendingRulesFrom.lineNumber);
+            matches.at(i).forEach([&result](qint64 line) {
+                result.lines.append(line);
+            });
+        }
+
+        storeCachedResult(m_pendingRuleKeys.at(i), result, result.lines.memoryUsage());
+    }
+
+    m_pendingRuleKeys.clear();
+}
+
+QAbstractTableModel *   xDocument::findResults() const {
+    return m_findResultsModel;
+}
+
+void        xDocument::onOccurrenceFound(searchResult item, bool bFound) {
+    if (!bFound) {
+        emit message(tr("Pattern not found"), 3000);
+        return;
     }
 
-    emit layoutChanged();
+    // worker scans from arbitrary offset, so line number is known only if
+    // position is already indexed
+
+    item.lineNumber = m_fileIndex.lineByPosition(item.position);
+
+    emit message(tr("Found at position %1").arg(item.position), 3000);
+    emit occurrenceFound(item);
+}
+
+void        xDocument::onCheckpointsReady() {
+    // result of scan started for previously opened file is dropped
+
+    if (!m_checkpointsCancelled || *m_checkpointsCancelled)
+        return;
+
+    m_checkpoints = m_checkpointsWatcher->result();
+    m_checkpointsCancelled.reset();
 }
 
 void        xDocument::onIndexDataReady(linesData data, bool bCompleted) {
  
-    if (data.size() && m_fileIndex.size() && data.first() == m_fileIndex.last()) {
+    if (data.size() && m_fileIndex.size() && data.first() == lineData{ m_fileIndex.lastPosition(), m_fileIndex.lastLength() }) {
         data.removeFirst();
     }
 
     if (data.size()) {
-        if (m_fileIndex.size()) {
+        qint64 nFirstLine = m_fileIndex.size();
 
-            if  (data.first().position <= m_fileIndex.last().position) {
-                quint64 lookupIndex = data.first().position;
-                QVector<lineData>::reverse_iterator it = std::find_if(m_fileIndex.rbegin(), m_fileIndex.rend(), [lookupIndex](const lineData & item)->bool {
-                    return item.position >= lookupIndex;
-                });
+        if (m_fileIndex.size()) {
 
-                int nRemoveFromLine = std::distance(m_fileIndex.begin(), (it + 1).base());
-                int nRemoveToLine = m_fileIndex.size() - 1;
-                for (int i = nRemoveFromLine; i <= nRemoveToLine; i++) {
+            if  (data.first().position <= m_fileIndex.lastPosition()) {
+                qint64 nRemoveFromLine = m_fileIndex.lowerBound(data.first().position);
+                qint64 nRemoveToLine   = m_fileIndex.size() - 1;
+                for (qint64 i = nRemoveFromLine; i <= nRemoveToLine; i++) {
                     m_lineCache.remove(i);
                 }
 
-                m_fileIndex.erase((it+1).base(), m_fileIndex.end());                
+                // rewritten lines are checked again by live filter and
+                // live search, so their old results are dropped
+
+                if (m_liveSearchId) {
+                    m_findResultsModel->truncateAtPosition(m_fileIndex.position(nRemoveFromLine));
+                }
+
+                m_fileIndex.truncate(nRemoveFromLine);
+                nFirstLine = nRemoveFromLine;
+
+                if (m_liveFilterId) {
+                    m_filterIndex.truncate(nRemoveFromLine);
+                    m_updateCoalescer->requestLayout();
+                }
+            }
+        }
+
+        for (const lineData & line : data) {
+            m_fileIndex.append(line.position, line.length);
+        }
+
+        m_fileSize = qMax(m_fileSize, indexedSize());
+
+        if (!m_bFilterActive) {
+            m_updateCoalescer->requestAppend(nFirstLine, m_fileIndex.size() - nFirstLine);
+        }
+
+        continueDensity();
+    }
+
+    if (bCompleted && m_bIndexing) {
+        m_bIndexing = false;
+        m_updateCoalescer->requestLayout();
+        emit message(tr("Document ready"), 3000);
+
+        continueDensity();
+
+        QString     filePath = m_filePath;
+        xLineIndex  index    = m_fileIndex;
+        QtConcurrent::run([filePath, index]() {
+            xIndexCache::save(filePath, index);
+        });
+    }
+}
+
+void        xDocument::onLiveMatchesReady(int filterRulesId, const QVector<quint64> & filterMatches, int searchRulesId, const searchResults & searchMatches) {
+    if (m_liveFilterId && (filterRulesId == m_liveFilterId)) {
+        qint64 nFirstLine = m_filterIndex.size();
+
+        // lines already scanned by filter itself may come again, index
+        // drops them as they are not after its last line
+
+        for (quint64 position : filterMatches) {
+            m_filterIndex.append(m_fileIndex.lineByPosition(position));
+        }
+        m_filterCoveredSize = m_fileSize;
+
+        if (m_bFilterActive && (m_filterIndex.size() > nFirstLine)) {
+            m_updateCoalescer->requestAppend(nFirstLine, m_filterIndex.size() - nFirstLine);
+        }
+    }
+
+    if (m_liveSearchId && (searchRulesId == m_liveSearchId) && !searchMatches.isEmpty()) {
+        searchResults   appended;
+        qint64          nLastLine = m_findResultsModel->lastLineNumber();
+
+        for (searchResult item : searchMatches) {
+            item.lineNumber = m_fileIndex.lineByPosition(item.position);
+            if (item.lineNumber > nLastLine) {
+                appended << item;
+                nLastLine = item.lineNumber;
+            }
+        }
+
+        m_findResultsModel->appendItems(appended);
+    }
+}
+
+void        xDocument::startLiveFilter(quint64 fromPosition) {
+    m_liveFilterId = ++m_liveRulesCounter;
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("setWatchFilter(QByteArray,filterRules,int,quint64)");
+        method = m_fileProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_fileProcessor, Qt::QueuedConnection,
+        Q_ARG(QByteArray, m_liveFilterEncoding),
+        Q_ARG(filterRules, m_liveFilterRules),
+        Q_ARG(int, m_liveFilterId),
+        Q_ARG(quint64, fromPosition));
+}
+
+void        xDocument::stopLiveFilter() {
+    if (!m_liveFilterId)
+        return;
+
+    m_liveFilterId = 0;
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("setWatchFilter(QByteArray,filterRules,int,quint64)");
+        method = m_fileProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_fileProcessor, Qt::QueuedConnection,
+        Q_ARG(QByteArray, QByteArray()),
+        Q_ARG(filterRules, filterRules()),
+        Q_ARG(int, 0),
+        Q_ARG(quint64, 0));
+}
+
+void        xDocument::startLiveSearch(quint64 fromPosition) {
+    m_liveSearchId = ++m_liveRulesCounter;
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("setWatchSearch(QByteArray,searchRequestItem,int,quint64)");
+        method = m_fileProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_fileProcessor, Qt::QueuedConnection,
+        Q_ARG(QByteArray, m_searchEncoding),
+        Q_ARG(searchRequestItem, m_liveSearchItem),
+        Q_ARG(int, m_liveSearchId),
+        Q_ARG(quint64, fromPosition));
+}
+
+void        xDocument::stopLiveSearch() {
+    if (!m_liveSearchId)
+        return;
+
+    m_liveSearchId = 0;
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_fileProcessor->metaObject()->indexOfMethod("setWatchSearch(QByteArray,searchRequestItem,int,quint64)");
+        method = m_fileProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_fileProcessor, Qt::QueuedConnection,
+        Q_ARG(QByteArray, QByteArray()),
+        Q_ARG(searchRequestItem, searchRequestItem()),
+        Q_ARG(int, 0),
+        Q_ARG(quint64, 0));
+}
+
+void        xDocument::setDensityRules(const QVector<searchRequestItem> & items, const QByteArray & encoding) {
+    if ((items == m_densityItems) && (encoding == m_densityEncoding))
+        return;
+
+    m_densityItems    = items;
+    m_densityEncoding = encoding;
+
+    restartDensity();
+}
+
+const densityData & xDocument::density() const {
+    return m_density;
+}
+
+void        xDocument::restartDensity() {
+    int nGeneration = m_density.generation + 1;
+
+    // runs of previous generation already queued are skipped by worker
+
+    m_densityProcessor->setDensityGeneration(nGeneration);
+
+    if (m_densityProcessor->isBusy()) {
+        m_densityProcessor->interrupt();
+    }
+
+    m_density            = densityData();
+    m_density.generation = nGeneration;
+    m_density.cellSize   = qMax<quint64>(m_densityMinCellSize, m_fileSize / (m_densityMaxCells / 2));
+    m_density.counts.resize(m_densityItems.size());
+    m_bDensityRunning    = false;
+
+    emit densityChanged();
+
+    continueDensity();
+}
+
+void        xDocument::continueDensity() {
+    if (m_bDensityRunning || m_bIndexing || m_densityItems.isEmpty() || m_filePath.isEmpty())
+        return;
+
+    // appended data is picked up from index updates
+
+    if (m_fileSize <= m_density.coveredTo)
+        return;
+
+    m_bDensityRunning   = true;
+    m_densityStartSize  = m_fileSize;
+
+    static int          methodIndex = -1;
+    static QMetaMethod  method;
+
+    if (methodIndex == -1) {
+        methodIndex = m_densityProcessor->metaObject()->indexOfMethod("computeDensity(QString,QByteArray,QVector<searchRequestItem>,quint64,quint64,int)");
+        method = m_densityProcessor->metaObject()->method(methodIndex);
+    }
+
+    method.invoke(m_densityProcessor, Qt::QueuedConnection,
+        Q_ARG(QString, m_filePath),
+        Q_ARG(QByteArray, m_densityEncoding),
+        Q_ARG(QVector<searchRequestItem>, m_densityItems),
+        Q_ARG(quint64, m_density.coveredTo),
+        Q_ARG(quint64, m_density.cellSize),
+        Q_ARG(int, m_density.generation));
+}
+
+void        xDocument::onDensityReady(densityData data, bool bCompleted) {
+    if (data.generation != m_density.generation)
+        return;
+
+    // worker keeps cell size it was started with, while document may have
+    // merged cells since then as file grew
+
+    for (int i = 0; i < data.counts.size() && i < m_density.counts.size(); i++) {
+        const QVector<quint32> & source = data.counts[i];
+        QVector<quint32> &       target = m_density.counts[i];
+
+        for (int j = 0; j < source.size(); j++) {
+            if (!source[j])
+                continue;
+
+            int nCell = ((data.firstCell + j) * data.cellSize) / m_density.cellSize;
+            if (target.size() <= nCell) {
+                target.resize(nCell + 1);
+            }
+            target[nCell] += source[j];
+        }
+    }
+
+    // when file outgrows cell budget neighbour cells are merged
+
+    bool bMerge = false;
+    for (const QVector<quint32> & counts : m_density.counts) {
+        bMerge |= (counts.size() > m_densityMaxCells);
+    }
+
+    if (bMerge) {
+        m_density.cellSize *= 2;
+
+        for (QVector<quint32> & counts : m_density.counts) {
+            QVector<quint32>    merged((counts.size() + 1) / 2);
+            for (int j = 0; j < counts.size(); j++) {
+                merged[j / 2] += counts[j];
             }
+            counts = merged;
         }
-         
-        m_fileIndex.append(data);        
-        emit layoutChanged();
+    }
 
-        if (bCompleted) {
-            emit message(tr("Document ready"), 3000);
+    m_density.coveredTo = qMax(m_density.coveredTo, data.coveredTo);
+
+    emit densityChanged();
+
+    // data appended while worker was running is picked up at once,
+    // unterminated tail alone does not restart it
+
+    if (bCompleted) {
+        m_bDensityRunning = false;
+
+        if (m_fileSize > m_densityStartSize) {
+            continueDensity();
         }
     }
 }
 
+void        xDocument::setResultCacheBudget(qint64 nBytes) {
+    m_resultCacheSize = qMax<qint64>(0, nBytes);
+    m_resultCache.setMaxCost(m_resultCacheSize / m_resultCacheUnit);
+}
+
+qint64      xDocument::resultCacheBudget() const {
+    return m_resultCacheSize;
+}
+
+int         xDocument::resultCacheHits() const {
+    return m_resultCacheHits;
+}
+
+int         xDocument::resultCacheMisses() const {
+    return m_resultCacheMisses;
+}
+
+QString     xDocument::searchCacheKey(const searchRequestItem & item, const QByteArray & encoding) const {
+    Qt::CaseSensitivity cs      = Qt::CaseSensitive;
+    QString             pattern;
+
+    if (item.type == PatternSearch) {
+        cs      = item.matcher.caseSensitivity();
+        pattern = item.matcher.pattern();
+    }
+    else if (item.type == RegExpSearch) {
+        cs      = (item.regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+        pattern = item.regexp.pattern();
+    }
+    else if (item.type == ExpressionSearch) {
+        pattern = item.expression;
+    }
+
+    return QString("%1:%2:%3:%4:%5").arg(m_generation).arg(QString::fromLatin1(encoding)).arg(item.type).arg(cs).arg(pattern);
+}
+
+QString     xDocument::filterCacheKey(const filterRules & rules, const QByteArray & encoding) const {
+    QStringList keys;
+    for (const filterRule & rule : rules) {
+        if (rule.isActive) {
+            keys << searchCacheKey(rule.filter, encoding);
+        }
+    }
+
+    return QString("filter\n") + keys.join('\n');
+}
+
+QString     xDocument::ruleCacheKey(const searchRequestItem & item, const QByteArray & encoding) const {
+    return QString("rule\n") + searchCacheKey(item, encoding);
+}
+
+searchRange xDocument::resumePoint() const {
+    if (!m_fileIndex.size())
+        return searchRange();
+
+    return searchRange{ m_fileIndex.lastPosition(), m_fileIndex.size() - 1 };
+}
+
+void        xDocument::countCacheLookup(bool bHit) {
+    if (bHit) {
+        m_resultCacheHits++;
+    }
+    else {
+        m_resultCacheMisses++;
+    }
+
+    emit resultCacheChanged();
+}
+
+void        xDocument::storeCachedResult(const QString & key, const cachedResult & result, quint64 nBytes) {
+    int nCost = qMax<quint64>(1, nBytes / m_resultCacheUnit);
+    if (nCost > m_resultCache.maxCost())
+        return;
+
+    m_resultCache.insert(key, new cachedResult(result), nCost);
+}
+
 int         xDocument::currentOperationProgress() const {
     return m_fileProcessor->currentProgress();
 }
@@ -428,22 +1632,18 @@ filterRule                xDocument::toggleFilterRuleVisibility(const filterRule
     return filterRule();
 }
 
-int                 xDocument::logicalToSourceLineNumber(int lineNumber) const {
+qint64              xDocument::logicalToSourceLineNumber(qint64 lineNumber) const {
     if (!m_bFilterActive)
         return lineNumber;
 
-    QMap<int,int>::const_iterator it = m_filterIndex.reverseIndex.find(lineNumber);
-
-    return (it == m_filterIndex.reverseIndex.end() ? -1 : it.value());
+    return m_filterIndex.sourceLine(lineNumber);
 }
 
-int                 xDocument::sourceToLogicalLineNumber(int lineNumber) const {
+qint64              xDocument::sourceToLogicalLineNumber(qint64 lineNumber) const {
     if (!m_bFilterActive)
         return lineNumber;
 
-    QMap<int, int>::const_iterator it = m_filterIndex.forwardIndex.find(lineNumber);
-
-    return (it == m_filterIndex.forwardIndex.end() ? -1 : it.value());
+    return m_filterIndex.filteredLine(lineNumber);
 }
 
 bool                xDocument::isFilterRulesEnabled() const {
@@ -451,14 +1651,21 @@ bool                xDocument::isFilterRulesEnabled() const {
 }
 
 void         xDocument::initModels() {
-    m_findResultsModel->setColumntCount(2);
+    m_findResultsModel->setColumnCount(2);
     m_findResultsModel->setDataCallback([this](int row, int column, int /* role */) -> QVariant {
-        const searchResult & item = m_findResultsModel->itemAt(row);
+        qint64 nLineNumber = m_findResultsModel->lineNumber(row);
         switch (column) {
         case findResultColumnLineNumber:
-            return item.lineNumber + 1;
-        case findResultColumnText:
-            return item.line.trimmed();
+            return nLineNumber + 1;
+        case findResultColumnText: {
+            // text is decoded only for rows shown by view
+
+            QTextCodec * pCodec = QTextCodec::codecForName(m_searchEncoding);
+            if (!pCodec) {
+                pCodec = QTextCodec::codecForLocale();
+            }
+            return pCodec->toUnicode(sourceLine(nLineNumber)).trimmed();
+        }
         }
         return QVariant();
     }, Qt::DisplayRole);
@@ -478,20 +1685,29 @@ void         xDocument::initModels() {
     }, Qt::DisplayRole);
 
     m_findResultsModel->setFlagsCallback([this](int row, int /*column*/, Qt::ItemFlags defaultFlags) -> Qt::ItemFlags {
-        const searchResult & item = m_findResultsModel->itemAt(row);
-        if (logicalToSourceLineNumber(item.lineNumber) == -1) {
+        if (sourceToLogicalLineNumber(m_findResultsModel->lineNumber(row)) == -1) {
             return (defaultFlags & ~(Qt::ItemIsEnabled));
         }
 
         return defaultFlags;
     });
 
-    m_filtersModel->setColumntCount(2);
+    m_filtersModel->setColumnCount(2);
     m_filtersModel->setDataCallback([this](int row, int column, int /*role*/) -> QVariant {
         const filterRule & filterItem = m_filtersModel->itemAt(row);
         switch (column) {
         case filterColumnText:
-            return filterItem.filter.type == PatternSearch ? filterItem.filter.matcher.pattern() : filterItem.filter.regexp.pattern();
+            switch (filterItem.filter.type) {
+            case PatternSearch:
+                return filterItem.filter.matcher.pattern();
+            case RegExpSearch:
+                return filterItem.filter.regexp.pattern();
+            case ExpressionSearch:
+                return filterItem.filter.expression;
+            default:
+                break;
+            }
+            break;
         }
 
         return QVariant();
@@ -26,10 +26,21 @@
 #include <QFile>
 #include <QRegularExpression>
 #include <QCache>
+#include <QSharedPointer>
+#include <QElapsedTimer>
 
 #include "xvaluelistmodel.h"
+#include "xlineindex.h"
+#include "xfilterindex.h"
+#include "xlinebitmap.h"
 
 class xFileProcessor;
+class xFilterExpression;
+class QTimer;
+template <typename T> class QFutureWatcher;
+class xUpdateCoalescer;
+class xSearchResultsModel;
+class xSearchResultList;
 
 enum {
     findResultColumnLineNumber = 0,
@@ -56,22 +67,31 @@ typedef QVector<lineData>   linesData;
 
 typedef struct {
     quint64     position    = 0;
-    int         lineNumber  = 0;
+    qint64      lineNumber  = 0;
     int         matchLength = 0;
-    QString     line;
 } searchResult;
 typedef QVector<searchResult>   searchResults;
 
+struct searchRange {
+    quint64     position    = 0;
+    qint64      lineNumber  = 0;
+};
+typedef QVector<searchRange>    searchRanges;
+
 enum SearchRequestType {
     Undef            = 0,
     PatternSearch    = 1,
-    RegExpSearch     = 2    
+    RegExpSearch     = 2,
+    ExpressionSearch = 3
 };
 
 struct searchRequestItem {   
     SearchRequestType   type  = Undef;
     QStringMatcher      matcher;
     QRegularExpression  regexp;
+    QString             expression;
+
+    QSharedPointer<const xFilterExpression> compiled;
 
     bool    operator ==(const searchRequestItem & other) const {
         if (type != other.type)
@@ -82,6 +102,10 @@ struct searchRequestItem {
                 return ((matcher.pattern() == other.matcher.pattern()) && (matcher.caseSensitivity() == other.matcher.caseSensitivity()));
             case RegExpSearch:
                 return (regexp.pattern() == other.regexp.pattern());
+            case ExpressionSearch:
+                return (expression == other.expression);
+            default:
+                break;
         }
 
         return false;
@@ -101,6 +125,8 @@ struct searchRequestItem {
         return item;
     };
 
+    static  searchRequestItem       expressionSearch(const QString & expression, QString * pError = nullptr);
+
     bool    isValid() const { return type != Undef; };
 };
 
@@ -116,10 +142,20 @@ struct filterRule {
 };
 typedef QVector<filterRule>   filterRules;
 
-typedef struct {
-    QMap<int, int>       forwardIndex;
-    QMap<int, int>       reverseIndex;
-} documentIndex;
+// matches per fixed size byte cell, one vector of counts per rule
+
+struct densityData {
+    int                         generation = 0;
+    quint64                     cellSize   = 0;
+    quint64                     firstCell  = 0;
+    quint64                     coveredTo  = 0;
+    QVector< QVector<quint32> > counts;
+};
+
+// source line numbers passed filter, in ascending order as file is read,
+// so document appends them to filter index as they come
+
+typedef QVector<qint64> filterLines;
 
 Q_DECLARE_METATYPE(lineData);
 Q_DECLARE_METATYPE(linesData);
@@ -127,12 +163,19 @@ Q_DECLARE_METATYPE(linesData);
 Q_DECLARE_METATYPE(searchResult);
 Q_DECLARE_METATYPE(searchResults);
 
+Q_DECLARE_METATYPE(searchRange);
+Q_DECLARE_METATYPE(searchRanges);
+
 Q_DECLARE_METATYPE(searchRequestItem);
 
 Q_DECLARE_METATYPE(filterRule);
 Q_DECLARE_METATYPE(filterRules);
 
-Q_DECLARE_METATYPE(documentIndex);
+Q_DECLARE_METATYPE(densityData);
+
+Q_DECLARE_METATYPE(xLineBitmap);
+Q_DECLARE_METATYPE(xLineIndex);
+Q_DECLARE_METATYPE(xFilterIndex);
 
 class xDocument: public QObject {
 	Q_OBJECT
@@ -148,28 +191,43 @@ public:
        
     void                invalidate();
 
-    int                 logicalLinesCount() const;
-    quint64             logicalLineStart(int lineNumber, bool * bOk = nullptr) const;
-    quint64             logicalLineEnd(int lineNumber, bool * bOk = nullptr) const;
-    int                 logicalLineByPosition(quint64 pos) const;
+    qint64              logicalLinesCount() const;
+    quint64             logicalLineStart(qint64 lineNumber, bool * bOk = nullptr) const;
+    quint64             logicalLineEnd(qint64 lineNumber, bool * bOk = nullptr) const;
+    qint64              logicalLineByPosition(quint64 pos) const;
 
-    QByteArray          logicalLine(int lineNumber);
-    QVector<QByteArray> logicalLines(int fromLine, int toLine);
-    QByteArray          logicalLinesAsText(int fromLine, int toLine);
+    QByteArray          logicalLine(qint64 lineNumber);
+    QByteArray          sourceLine(qint64 lineNumber);
+    QVector<QByteArray> logicalLines(qint64 fromLine, qint64 toLine);
+    QByteArray          logicalLinesAsText(qint64 fromLine, qint64 toLine);
 
-    int                 logicalToSourceLineNumber(int lineNumber) const;
-    int                 sourceToLogicalLineNumber(int lineNumber) const;
+    qint64              logicalToSourceLineNumber(qint64 lineNumber) const;
+    qint64              sourceToLogicalLineNumber(qint64 lineNumber) const;
 
-    quint64             logicalLinePosition(int lineNumber) const;
-    int                 logicalLinesBetweenPositions(quint64 start, quint64 stop) const;
+    quint64             logicalLinePosition(qint64 lineNumber) const;
+    qint64              logicalLinesBetweenPositions(quint64 start, quint64 stop) const;
 
     QByteArray          text(quint64 from, quint64 to);
+
+    quint64             fileSize() const;
+    quint64             indexedSize() const;
+    bool                isPositionIndexed(quint64 pos) const;
+    qint64              estimatedLineNumber(quint64 pos) const;
+
+    quint64             resolveLineStart(quint64 pos);
+    linesData           resolveLines(quint64 pos, int nLines);
              
-    QAbstractTableModel *   findResults() const { return m_findResultsModel; };
+    QAbstractTableModel *   findResults() const;
     QAbstractTableModel *   filters() const { return m_filtersModel; };
        
 
-    void                search(const searchRequestItem &  requestItem, const QByteArray & encoding, bool bStore, quint64 startPosition = 0, int maxOccurencies = 500);
+    bool                search(const searchRequestItem &  requestItem, const QByteArray & encoding, bool bStore, quint64 startPosition = 0, int maxOccurencies = 0);
+    void                cancelSearch();
+    bool                isSearching() const;
+
+    bool                startGlobalSearch(const searchRequestItem & requestItem, const QByteArray & encoding, int maxOccurencies);
+    void                cancelGlobalSearch();
+    void                findOccurrence(const searchRequestItem & requestItem, const QByteArray & encoding, quint64 position, bool bBackward);
     void                filter(const filterRules & rules, const QByteArray & encoding, bool bSetActive = true);
 
     void                setFilterRulesEnabled(bool bEnabled);
@@ -184,46 +242,173 @@ public:
 
     int                 currentOperationProgress() const;
 
+    void                setResultCacheBudget(qint64 nBytes);
+    qint64              resultCacheBudget() const;
+    int                 resultCacheHits() const;
+    int                 resultCacheMisses() const;
+
+    void                setDensityRules(const QVector<searchRequestItem> & items, const QByteArray & encoding);
+    const densityData & density() const;
+
     void                setAutoRefresh(bool b);
     bool                autoRefresh() const;
     
 signals:
 
     void        layoutChanged();
+    void        linesAppended(qint64 firstLine, qint64 count);
+    void        occurrenceFound(const searchResult & item);
+    void        resultCacheChanged();
+    void        globalSearchResultsReady(const searchResults & results, bool bCompleted);
+    void        densityChanged();
     void        progressChanged(int);
     void        message(const QString & message, int timeout = 0);
     
 public slots:
 
-    void        onIndexDataReady(linesData index , bool bCompleted);
-    void        onFilterDataReady(documentIndex data, bool bCompleted);
-    void        onSearchResultsReady(searchResults results, bool bCompleted);
+    void        onCheckpointsReady();
+    void        onIndexCacheLoaded();
+    void        onDataAvailable();
+    void        onOccurrenceFound(searchResult item, bool bFound);
+    void        onDensityReady(densityData data, bool bCompleted);
 
 protected:
 
+    // completed search, filter or single filter rule result, lines before
+    // resumeFrom do not change while file only grows, so after append scan
+    // continues from there
+
+    struct cachedResult {
+        QSharedPointer<const xSearchResultList> results;
+        xFilterIndex    index;
+        xLineBitmap     lines;
+        searchRange     resumeFrom;
+        quint64         fileSize    = 0;
+    };
+
     void        initModels();
 
+    QString     searchCacheKey(const searchRequestItem & item, const QByteArray & encoding) const;
+    QString     filterCacheKey(const filterRules & rules, const QByteArray & encoding) const;
+    QString     ruleCacheKey(const searchRequestItem & item, const QByteArray & encoding) const;
+    searchRange resumePoint() const;
+    void        storeCachedResult(const QString & key, const cachedResult & result, quint64 nBytes);
+    void        countCacheLookup(bool bHit);
+    void        finishFilter(const QString & key, bool bSetActive);
+
+    void        startLiveFilter(quint64 fromPosition);
+    void        stopLiveFilter();
+    void        startLiveSearch(quint64 fromPosition);
+    void        stopLiveSearch();
+
+    searchRanges    parallelSearchRanges() const;
+
+    void        continueIndex();
+    bool        interruptProcessor();
+
+    void        restartDensity();
+    void        continueDensity();
+
+    void        processPendingData();
+    void        onIndexDataReady(linesData index , bool bCompleted);
+    void        onFilterDataReady(filterLines data, bool bCompleted);
+    void        onFilterRulesMatched(int requestId, QVector<xLineBitmap> matches, QVector<bool> complete);
+    void        onLiveMatchesReady(int filterRulesId, const QVector<quint64> & filterMatches, int searchRulesId, const searchResults & searchMatches);
+    void        onSearchResultsReady(searchResults results, bool bCompleted);
+
 
 protected:
 
     int                     m_blockSize     = 1000000;
     int                     m_notifyPerLine = 1000;
     int                     m_lineCacheSize = 500;
+    qint64                  m_resultCacheSize = 64 * 1024 * 1024;
+    int                     m_frameInterval = 16;
+
+    const quint64           m_checkpointMinStride = 16 * 1024 * 1024;
+    const int               m_checkpointMaxCount  = 4096;
+    const int               m_sparseReadSize      = 65536;
+
+    const quint64           m_densityMinCellSize  = 64 * 1024;
+    const int               m_densityMaxCells     = 16384;
+
+    const int               m_narrowFilterRatio       = 4;
 
-    QVector<lineData>       m_fileIndex; 
+    const quint64           m_parallelSearchThreshold = 64 * 1024 * 1024;
+    const quint64           m_searchChunkMinSize      = 8 * 1024 * 1024;
+    const quint64           m_searchChunkMaxSize      = 256 * 1024 * 1024;
+
+    xLineIndex              m_fileIndex;
+    bool                    m_bIndexing     = false;
+
+    // index cache is read by worker, document is shown once it is ready
+    QFutureWatcher<int> *                   m_indexCacheWatcher = nullptr;
+    QSharedPointer<xLineIndex>              m_indexCacheLoad;
+
+    QVector<quint64>        m_checkpoints;
+    QFutureWatcher< QVector<quint64> > *    m_checkpointsWatcher = nullptr;
+    QSharedPointer<QAtomicInt>              m_checkpointsCancelled;
+    quint64                 m_fileSize      = 0;
 
     bool                    m_bFilterActive = false;
-    documentIndex           m_filterIndex;
+    xFilterIndex            m_filterIndex;
+    QStringList             m_filterRuleKeys;
+    quint64                 m_filterCoveredSize = 0;
     
     QString                 m_filePath;
     QFile                   m_file;
 
-    QCache<int, QByteArray> m_lineCache;
-
-    xValueCollection<searchResult>       * m_findResultsModel   = nullptr;
+    QCache<qint64, QByteArray> m_lineCache;
+
+    const int               m_resultCacheUnit       = 1024;
+
+    QCache<QString, cachedResult>   m_resultCache;
+    int                     m_generation            = 0;
+    int                     m_resultCacheHits       = 0;
+    int                     m_resultCacheMisses     = 0;
+
+    QString                 m_pendingSearchKey;
+    cachedResult            m_pendingSearch;
+    int                     m_pendingSearchLimit    = 0;
+    QString                 m_pendingFilterKey;
+    cachedResult            m_pendingFilter;
+    int                     m_filterRequestId       = 0;
+    QStringList             m_pendingRuleKeys;
+    searchRange             m_pendingRulesFrom;
+    cachedResult            m_pendingRules;
+    bool                    m_bFilterKnown          = false;
+    xLineBitmap             m_filterKnown;
+    QByteArray              m_searchEncoding;
+    bool                    m_bSearching    = false;
+
+    // completed filter and search are kept up to date by file watch,
+    // id tells which rules matches posted by worker were checked with
+
+    filterRules             m_liveFilterRules;
+    QByteArray              m_liveFilterEncoding;
+    searchRequestItem       m_liveSearchItem;
+    int                     m_liveRulesCounter      = 0;
+    int                     m_liveFilterId          = 0;
+    int                     m_liveSearchId          = 0;
+
+    xUpdateCoalescer    *   m_updateCoalescer   = nullptr;
+    QTimer              *   m_pendingDataTimer  = nullptr;
+    QElapsedTimer           m_pendingDataElapsed;
+
+    xSearchResultsModel                  * m_findResultsModel   = nullptr;
     xValueCollection<filterRule>         * m_filtersModel       = nullptr;
   
     xFileProcessor      *   m_fileProcessor                 = nullptr;    
+    xFileProcessor      *   m_densityProcessor              = nullptr;
+    xFileProcessor      *   m_findProcessor                 = nullptr;
+    xFileProcessor      *   m_globalSearchProcessor         = nullptr;
+    bool                    m_bGlobalSearching              = false;
+
+    QVector<searchRequestItem>  m_densityItems;
+    QByteArray                  m_densityEncoding;
+    densityData                 m_density;
+    bool                        m_bDensityRunning   = false;
+    quint64                     m_densityStartSize  = 0;
 };
 
 #endif
\ No newline at end of file
@@ -22,13 +22,38 @@
 #include <QElapsedTimer>
 #include <QTextCodec>
 #include <QTimerEvent>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#ifdef Q_OS_UNIX
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
 
 #include "xfileprocessor.h"
+#include "xlinescanner.h"
+#include "xmultimatcher.h"
+#include "xfilterexpression.h"
+#include "xfilterplan.h"
+#include "xregexpprefilter.h"
+#include "xsysteminformation.h"
 #include "xlog.h"
 
+static  const   int     checkpointProbeSize = 4096;
+static  const   quint64 narrowMergeGap      = 4096;
+
+// MB/s of bytes actually processed, runs from resume point or interrupted
+// ones process only part of file
+
+static  double  throughput(quint64 bytes, qint64 elapsed) {
+    return elapsed > 0 ? (bytes / 1024. / 1024.) * 1000. / elapsed : 0.;
+}
+
 xFileProcessor::xFileProcessor():
     QObject() {
     m_shutdownFlag = 0;
+    m_indexWorkers = xSystemInformation::coresAvailable();
+    m_indexPool    = new QThreadPool(this);
     xFileProcessorThread * pThread = new xFileProcessorThread(this);
     pThread->setObjectName("xFileProcessorThread");
     connect(pThread, &QThread::finished, pThread, &QThread::deleteLater);
@@ -86,7 +111,7 @@ void xFileProcessorThread::run() {
     qCDebug(logicDocument) << "xFileProcessorThread: run() finished";
 }
 
-void    xFileProcessor::searchData(QString fileName, QByteArray codecName, searchRequestItem request, quint64 /* fromPosition */, int maxOccurences, int notifyPerLines, int blockSize) {
+void    xFileProcessor::searchData(QString fileName, QByteArray codecName, searchRequestItem request, searchRange from, int maxOccurences, int notifyPerLines, int blockSize) {
     BusyFlag    busy(m_busyFlag);
 
     searchResults    currentPart;
@@ -101,145 +126,1058 @@ void    xFileProcessor::searchData(QString fileName, QByteArray codecName, searc
         pCodec = QTextCodec::codecForLocale();
     }
     
-    processPerLine(fileName, pCodec, blockSize, [this, &currentPart, &request, notifyPerLines, maxOccurences, &nTotalFound](quint64 startPosition, int /* lineLength */, int lineNumber, const QString & content, bool bLastLine) {
+    // plain patterns and literals required by regexp are searched in raw
+    // bytes, only lines containing them are decoded
+
+    searchRequestItem   prefilter   = (request.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(request.regexp) : searchRequestItem();
+    xByteMatcher        byteMatcher = (request.type == RegExpSearch) ? xByteMatcher(prefilter, pCodec) : xByteMatcher(request, pCodec);
+
+    // scan may start from known line, e.g. when only appended part of file
+    // has to be searched, line numbers are counted from it
+
+    xFilterPlan         plan        = (request.type == ExpressionSearch) ? xFilterPlan(request, pCodec) : xFilterPlan();
+    quint64             nProcessedTo = from.position;
 
-        int nMatchLength = checkSearchItem(content, request);
+    processPerLine(fileName, pCodec, blockSize, [this, &currentPart, &request, &prefilter, &byteMatcher, &plan, &from, &nProcessedTo, pCodec, notifyPerLines, maxOccurences, &nTotalFound](quint64 startPosition, int lineLength, qint64 lineNumber, const char * pRaw, const QString & content, bool bLastLine) {
+        nProcessedTo = startPosition + lineLength;
+
+        QString text         = content;
+        int     nMatchLength = matchLine(pRaw, lineLength, pCodec, request, byteMatcher, prefilter, text, &plan);
 
         if (nMatchLength) {
 
             searchResult item;
             item.position             = startPosition;
             item.matchLength     = nMatchLength;
-            item.lineNumber      = lineNumber;
-            item.line            = content;
+            item.lineNumber      = from.lineNumber + lineNumber;
 
             currentPart << item;
 
             if ((!bLastLine &&currentPart.size() == notifyPerLines) || bLastLine) {
-                emit searchResultsReady(currentPart, bLastLine);
-                currentPart.clear();
+                postSearchResults(currentPart, bLastLine);
             }
 
             nTotalFound++;
 
             if ((maxOccurences > 0) && (nTotalFound == maxOccurences)) {
-                emit searchResultsReady(currentPart, true);
-                currentPart.clear();
+                postSearchResults(currentPart, true);
                 return false;
             }
         }
         else {
             if (bLastLine) {
-                emit searchResultsReady(currentPart, bLastLine);
-                currentPart.clear();
+                postSearchResults(currentPart, bLastLine);
             }
         }
 
         return true;
-    }, true);
+    }, byteMatcher.isValid() ? contentRaw : contentText, from.position);
 
     setProgress(100);
 
-    qCDebug(logicDocument) << "xFileProcessor: search in file " << fileName << " done in " << et.elapsed() << " ms";
+    qCDebug(logicDocument) << "xFileProcessor: search in file " << fileName << " done in " << et.elapsed() << " ms, " << throughput(nProcessedTo - from.position, et.elapsed()) << " MB/s";
 }
 
-void    xFileProcessor::createIndex(QString fileName, int notifyPerLines, int blockSize) {
+void    xFileProcessor::searchDataParallel(QString fileName, QByteArray codecName, searchRequestItem request, searchRanges ranges, int maxOccurences, int notifyPerLines, int blockSize) {
+    QFile   f(fileName);
+    uchar * pMapped   = nullptr;
+    quint64 totalSize = 0;
+
+    if (m_useMemoryMapping && (m_indexWorkers > 1) && !ranges.isEmpty() && f.open(QIODevice::ReadOnly) && !f.isSequential()) {
+        totalSize = f.size();
+        if (totalSize > ranges.last().position) {
+            pMapped = f.map(0, totalSize);
+        }
+    }
+
+    if (!pMapped) {
+        qCDebug(logicDocument) << "xFileProcessor: unable to search " << fileName << " in parallel, falling back to sequential search";
+        searchData(fileName, codecName, request, searchRange(), maxOccurences, notifyPerLines, blockSize);
+        return;
+    }
+
     BusyFlag    busy(m_busyFlag);
- 
-    linesData    currentPart;
+
+    QElapsedTimer   et;
+    et.start();
+
+    setProgress(0);
+
+    QTextCodec * pCodec = QTextCodec::codecForName(codecName);
+    if (!pCodec) {
+        pCodec = QTextCodec::codecForLocale();
+    }
+
+    adviseSequentialAccess(pMapped, totalSize);
+
+    const char *    pData    = (const char *)pMapped;
+    int             nWorkers = m_indexWorkers;
+    int             nChunks  = ranges.size();
+    int             nWindow  = nWorkers * 2;
+    searchRequestItem   prefilter   = (request.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(request.regexp) : searchRequestItem();
+    xByteMatcher        byteMatcher = (request.type == RegExpSearch) ? xByteMatcher(prefilter, pCodec) : xByteMatcher(request, pCodec);
+
+    // chunks are matched independently, but merged strictly in order, once
+    // limit is reached by earlier chunks all later ones are stopped
+
+    QAtomicInt      stopAfterChunk = nChunks;
+
+    m_indexPool->setMaxThreadCount(nWorkers);
+
+    qCDebug(logicDocument) << "xFileProcessor: searching " << fileName << " with " << nWorkers << " workers, " << nChunks << " chunks";
+
+    QVector< QFuture<searchResults> >   chunks(nChunks);
+
+    auto scheduleChunk = [this, &chunks, &ranges, &request, &prefilter, &byteMatcher, &stopAfterChunk, pData, pCodec, totalSize, maxOccurences](int nChunk) {
+        quint64 from      = ranges[nChunk].position;
+        quint64 to        = (nChunk + 1 < ranges.size()) ? ranges[nChunk + 1].position : totalSize;
+        qint64  firstLine = ranges[nChunk].lineNumber;
+        chunks[nChunk] = QtConcurrent::run(m_indexPool, [this, &request, &prefilter, &byteMatcher, &stopAfterChunk, pData, pCodec, from, to, firstLine, maxOccurences, nChunk]() {
+            return searchChunk(pData, from, to, firstLine, pCodec, request, prefilter, byteMatcher, maxOccurences, nChunk, stopAfterChunk);
+        });
+    };
+
+    for (int i = 0; i < qMin(nWindow, nChunks); i++) {
+        scheduleChunk(i);
+    }
+
+    searchResults   currentPart;
+    int             nTotalFound  = 0;
+    int             nLastChunk   = nChunks - 1;
+    quint64         nProcessedTo = ranges.first().position;
+
+    for (int i = 0; i < nChunks; i++) {
+        searchResults   results = chunks[i].result();
+        chunks[i] = QFuture<searchResults>();
+
+        nProcessedTo = (i + 1 < nChunks) ? ranges[i + 1].position : totalSize;
+
+        if ((interruptionState() != requestCompleted) || (i == nLastChunk)) {
+            nLastChunk = i;
+        }
+        else if (i + nWindow < nChunks) {
+            scheduleChunk(i + nWindow);
+        }
+
+        for (searchResult & item : results) {
+            currentPart << std::move(item);
+            nTotalFound++;
+
+            if ((maxOccurences > 0) && (nTotalFound == maxOccurences)) {
+                stopAfterChunk = i;
+                nLastChunk     = i;
+                break;
+            }
+
+            if (currentPart.size() == notifyPerLines) {
+                postSearchResults(currentPart, false);
+            }
+        }
+
+        if (i == nLastChunk) {
+            for (int j = i + 1; j < qMin(i + nWindow + 1, nChunks); j++) {
+                chunks[j].waitForFinished();
+            }
+            break;
+        }
+
+        // partial results are handed over as soon as chunk is merged,
+        // so first hits are visible before whole file is searched
+
+        if (currentPart.size()) {
+            postSearchResults(currentPart, false);
+        }
+
+        setProgress(100.*(double)(i + 1) / (double)nChunks);
+    }
+
+    if (interruptionState() == requestCompleted) {
+        postSearchResults(currentPart, true);
+    }
+
+    f.unmap(pMapped);
+
+    setProgress(100);
+
+    qCDebug(logicDocument) << "xFileProcessor: parallel search in file " << fileName << " done in " << et.elapsed() << " ms, " << throughput(nProcessedTo - ranges.first().position, et.elapsed()) << " MB/s";
+}
+
+searchResults   xFileProcessor::searchChunk(const char * pData, quint64 from, quint64 to, qint64 firstLine, QTextCodec * pCodec, const searchRequestItem & request, const searchRequestItem & prefilter, const xByteMatcher & byteMatcher, int maxOccurences, int nChunk, const QAtomicInt & stopAfterChunk) {
+    searchResults   results;
+
+    // plan keeps counters of its steps, so every chunk has own one
+
+    xFilterPlan     plan        = (request.type == ExpressionSearch) ? xFilterPlan(request, pCodec) : xFilterPlan();
+    const char *    pEnd        = pData + to;
+    const char *    pLine       = pData + from;
+    qint64          nLineNumber = firstLine;
+    quint64         nChecked    = 0;
+
+    while (pLine < pEnd) {
+        const char * pNewline   = xLineScanner::findNewline(pLine, pEnd);
+        int          nLineLength = (pNewline == pEnd) ? (pEnd - pLine) : (pNewline - pLine + 1);
+        QString      text;
+        int          nMatchLength = matchLine(pLine, nLineLength, pCodec, request, byteMatcher, prefilter, text, &plan);
+
+        if (nMatchLength) {
+            searchResult item;
+            item.position    = pLine - pData;
+            item.matchLength = nMatchLength;
+            item.lineNumber  = nLineNumber;
+
+            results << item;
+
+            if ((maxOccurences > 0) && (results.size() == maxOccurences))
+                break;
+        }
+
+        nChecked += nLineLength;
+        if (nChecked >= m_parallelCheckInterval) {
+            nChecked = 0;
+            if ((interruptionState() != requestCompleted) || (nChunk > stopAfterChunk.loadAcquire()))
+                break;
+        }
+
+        nLineNumber++;
+        pLine += nLineLength;
+    }
+
+    return results;
+}
+
+void    xFileProcessor::findOccurrence(QString fileName, QByteArray codecName, searchRequestItem request, filterRules filter, quint64 position, bool bBackward, int blockSize) {
+    BusyFlag    busy(m_busyFlag);
+
+    QElapsedTimer   et;
+    et.start();
 
     setProgress(0);
 
+    QTextCodec * pCodec = QTextCodec::codecForName(codecName);
+    if (!pCodec) {
+        pCodec = QTextCodec::codecForLocale();
+    }
+
+    // empty plan passes every line when there is no active filter
+
+    xFilterPlan     filterPlan(filter, pCodec);
+    searchResult    item;
+    item.lineNumber = -1;
+
+    operationResult result = bBackward ? findBackward(fileName, pCodec, request, filterPlan, position, blockSize, &item) : findForward(fileName, pCodec, request, filterPlan, position, blockSize, &item);
+
+    setProgress(100);
+
+    if ((result == requestCompleted) || (result == unableToOpenFile)) {
+        emit occurrenceFound(item, item.matchLength > 0);
+    }
+
+    qCDebug(logicDocument) << "xFileProcessor: find " << (bBackward ? "previous" : "next") << " from " << position << " in file " << fileName << " done in " << et.elapsed() << " ms";
+}
+
+xFileProcessor::operationResult    xFileProcessor::findForward(const QString & fileName, QTextCodec * pCodec, const searchRequestItem & request, xFilterPlan & filterPlan, quint64 position, int blockSize, searchResult * pResult) {
+
+    // position inside of line means search starts from the next one
+
+    bool bSkipFirst = false;
+    if (position > 0) {
+        QFile f(fileName);
+        if (!f.open(QIODevice::ReadOnly)) {
+            return unableToOpenFile;
+        }
+
+        char c = 0;
+        f.seek(position - 1);
+        bSkipFirst = f.getChar(&c) && (c != '\n');
+    }
+
+    searchRequestItem   prefilter   = (request.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(request.regexp) : searchRequestItem();
+    xByteMatcher        byteMatcher = (request.type == RegExpSearch) ? xByteMatcher(prefilter, pCodec) : xByteMatcher(request, pCodec);
+
+    xFilterPlan         plan        = (request.type == ExpressionSearch) ? xFilterPlan(request, pCodec) : xFilterPlan();
+
+    return processPerLine(fileName, pCodec, blockSize, [this, &request, &prefilter, &byteMatcher, &plan, &filterPlan, &bSkipFirst, pCodec, pResult](quint64 startPosition, int lineLength, qint64 /*lineNumber*/, const char * pRaw, const QString & content, bool /*bLastLine*/) {
+        if (bSkipFirst) {
+            bSkipFirst = false;
+            return true;
+        }
+
+        QString text         = content;
+        int     nMatchLength = matchLine(pRaw, lineLength, pCodec, request, byteMatcher, prefilter, text, &plan);
+
+        if (nMatchLength && filterPlan.matches(pRaw, lineLength, text)) {
+            pResult->position    = startPosition;
+            pResult->matchLength = nMatchLength;
+            return false;
+        }
+
+        return true;
+    }, byteMatcher.isValid() ? contentRaw : contentText, position);
+}
+
+xFileProcessor::operationResult    xFileProcessor::findBackward(const QString & fileName, QTextCodec * pCodec, const searchRequestItem & request, xFilterPlan & filterPlan, quint64 position, int blockSize, searchResult * pResult) {
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return unableToOpenFile;
+    }
+
+    searchRequestItem   prefilter   = (request.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(request.regexp) : searchRequestItem();
+    xByteMatcher        byteMatcher = (request.type == RegExpSearch) ? xByteMatcher(prefilter, pCodec) : xByteMatcher(request, pCodec);
+    xFilterPlan         plan        = (request.type == ExpressionSearch) ? xFilterPlan(request, pCodec) : xFilterPlan();
+
+    // blocks are read from the end, only complete lines of each block are
+    // checked, head of block is left for the next (preceding) read
+
+    quint64     nEnd       = qMin<quint64>(position, f.size());
+    quint64     nStart     = nEnd;
+    qint64      nReadSize  = blockSize;
+    QByteArray  block;
+
+    while (nEnd > 0) {
+        operationResult state = interruptionState();
+        if (state != requestCompleted)
+            return state;
+
+        setProgress(100. * (double)(nStart - nEnd) / (double)nStart);
+
+        quint64 nBlockStart = (nEnd > (quint64)nReadSize) ? nEnd - nReadSize : 0;
+        block.resize(nEnd - nBlockStart);
+
+        f.seek(nBlockStart);
+        if (f.read(block.data(), block.size()) != block.size()) {
+            return unableToOpenFile;
+        }
+
+        const char * pBlockEnd = block.constData() + block.size();
+        const char * pLine     = block.constData();
+
+        if (nBlockStart > 0) {
+            const char * pNewline = xLineScanner::findNewline(block.constData(), pBlockEnd);
+            if (pNewline == pBlockEnd) {
+                // line is longer than block, read it at once
+
+                nReadSize *= 2;
+                continue;
+            }
+            pLine = pNewline + 1;
+        }
+
+        quint64 nLinesStart = nBlockStart + (pLine - block.constData());
+        bool    bFound      = false;
+
+        while (pLine < pBlockEnd) {
+            const char *    pNewline    = xLineScanner::findNewline(pLine, pBlockEnd);
+            int             nLineLength = (pNewline == pBlockEnd) ? (pBlockEnd - pLine) : (pNewline - pLine + 1);
+            QString         text;
+
+            int nMatchLength = matchLine(pLine, nLineLength, pCodec, request, byteMatcher, prefilter, text, &plan);
+            if (nMatchLength && filterPlan.matches(pLine, nLineLength, text)) {
+                pResult->position    = nBlockStart + (pLine - block.constData());
+                pResult->matchLength = nMatchLength;
+                bFound               = true;
+            }
+
+            pLine += nLineLength;
+        }
+
+        if (bFound)
+            break;
+
+        nEnd      = nLinesStart;
+        nReadSize = blockSize;
+    }
+
+    return requestCompleted;
+}
+
+void    xFileProcessor::computeDensity(QString fileName, QByteArray codecName, QVector<searchRequestItem> items, quint64 fromPosition, quint64 cellSize, int generation) {
+    BusyFlag    busy(m_busyFlag);
+
+    if (generation != m_densityGeneration)
+        return;
+
     QElapsedTimer   et;
     et.start();
 
-    processPerLine(fileName, nullptr, blockSize, [this, &currentPart, notifyPerLines](quint64 startPosition, int lineLength, int /*lineNumber*/, const QString & /* content */, bool bLastLine) {
-        currentPart << lineData{ startPosition, lineLength };
-        if ((!bLastLine &&currentPart.size() == notifyPerLines) || bLastLine) {
-            emit indexDataReady(currentPart, bLastLine);
-            currentPart.clear();
+    QTextCodec * pCodec = QTextCodec::codecForName(codecName);
+    if (!pCodec) {
+        pCodec = QTextCodec::codecForLocale();
+    }
+
+    QVector<searchRequestItem>  prefilters;
+    QVector<xByteMatcher>       byteMatchers;
+    QVector<xFilterPlan>        plans;
+
+    for (const searchRequestItem & item : items) {
+        searchRequestItem   prefilter = (item.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(item.regexp) : searchRequestItem();
+        prefilters   << prefilter;
+        byteMatchers << ((item.type == RegExpSearch) ? xByteMatcher(prefilter, pCodec) : xByteMatcher(item, pCodec));
+        plans        << ((item.type == ExpressionSearch) ? xFilterPlan(item, pCodec) : xFilterPlan());
+    }
+
+    densityData     current;
+    current.generation = generation;
+    current.cellSize   = cellSize;
+    current.firstCell  = fromPosition / cellSize;
+    current.coveredTo  = fromPosition;
+    current.counts.resize(items.size());
+
+    QElapsedTimer   notifyTimer;
+    notifyTimer.start();
+
+    // only complete lines are counted, unterminated tail is picked up
+    // on next incremental run when file grows
+
+    operationResult result = processPerLine(fileName, pCodec, m_densityBlockSize, [this, &current, &items, &prefilters, &byteMatchers, &plans, &notifyTimer, pCodec, generation](quint64 startPosition, int lineLength, qint64 /*lineNumber*/, const char * pRaw, const QString & /*content*/, bool /*bLastLine*/) {
+        if (generation != m_densityGeneration)
+            return false;
+
+        if ((lineLength == 0) || (pRaw[lineLength - 1] != '\n'))
+            return true;
+
+        int     nCell = startPosition / current.cellSize - current.firstCell;
+        QString text;
+
+        for (int i = 0; i < items.size(); i++) {
+            if (!matchLine(pRaw, lineLength, pCodec, items[i], byteMatchers[i], prefilters[i], text, &plans[i]))
+                continue;
+
+            QVector<quint32> & counts = current.counts[i];
+            if (counts.size() <= nCell) {
+                counts.resize(nCell + 1);
+            }
+            counts[nCell]++;
         }
+
+        current.coveredTo = startPosition + lineLength;
+
+        if (notifyTimer.elapsed() >= m_densityNotifyInterval) {
+            emit densityReady(current, false);
+
+            for (QVector<quint32> & counts : current.counts) {
+                counts.clear();
+            }
+            current.firstCell = current.coveredTo / current.cellSize;
+            notifyTimer.restart();
+        }
+
         return true;
-    }, false);
+    }, contentRaw, fromPosition, false);
+
+    if ((result == requestCompleted) && (generation == m_densityGeneration)) {
+        emit densityReady(current, true);
+    }
+
+    qCDebug(logicDocument) << "xFileProcessor: density from " << fromPosition << " in file " << fileName << " done in " << et.elapsed() << " ms";
+}
+
+// checkpoints are probed with random reads, so they are collected on global
+// thread pool and never hold processor thread in front of indexing
+
+QVector<quint64>    xFileProcessor::createCheckpoints(const QString & fileName, quint64 stride, const QAtomicInt & cancelled) {
+    QVector<quint64>    checkpoints;
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly) || f.isSequential() || !stride) {
+        return checkpoints;
+    }
 
-    qCDebug(logicDocument) << "xFileProcessor: rebuilding file " << fileName << " done in " << et.elapsed() << " ms";
+    QElapsedTimer   et;
+    et.start();
+
+    quint64             totalSize = f.size();
+    QByteArray          probe(checkpointProbeSize, Qt::Uninitialized);
+
+    for (quint64 nProbeStart = stride; nProbeStart < totalSize; nProbeStart += stride) {
+        if (cancelled) {
+            return QVector<quint64>();
+        }
+
+        // checkpoint is the first line start at or after probe position,
+        // lines longer than stride are left without a checkpoint
+
+        quint64 nReadFrom = nProbeStart - 1;
+        while (nReadFrom < qMin(nProbeStart + stride, totalSize)) {
+            f.seek(nReadFrom);
+            qint64 nReaded = f.read(probe.data(), probe.size());
+            if (nReaded <= 0) {
+                break;
+            }
+
+            const char * pEnd     = probe.constData() + nReaded;
+            const char * pNewline = xLineScanner::findNewline(probe.constData(), pEnd);
+            if (pNewline != pEnd) {
+                quint64 nCheckpoint = nReadFrom + (pNewline - probe.constData()) + 1;
+                if ((nCheckpoint < totalSize) && (checkpoints.isEmpty() || (checkpoints.last() < nCheckpoint))) {
+                    checkpoints << nCheckpoint;
+                }
+                break;
+            }
+
+            nReadFrom += nReaded;
+        }
+    }
+
+    qCDebug(logicDocument) << "xFileProcessor: " << checkpoints.size() << " checkpoints for " << fileName << " done in " << et.elapsed() << " ms";
+
+    return checkpoints;
+}
+
+void    xFileProcessor::createIndex(QString fileName, quint64 fromPosition, int notifyPerLines, int blockSize) {
+    BusyFlag    busy(m_busyFlag);
+ 
+    linesData    currentPart;
+
+    setProgress(0);
+
+    QElapsedTimer   et;
+    et.start();
+
+    quint64 nProcessedTo = fromPosition;
+
+    if ((fromPosition > 0) || (createIndexParallel(fileName, notifyPerLines, &nProcessedTo) == unableToMapFile)) {
+        processPerLine(fileName, nullptr, blockSize, [this, &currentPart, &nProcessedTo, notifyPerLines](quint64 startPosition, int lineLength, qint64 /*lineNumber*/, const char * /* pRaw */, const QString & /* content */, bool bLastLine) {
+            nProcessedTo = startPosition + lineLength;
+            currentPart << lineData{ startPosition, lineLength };
+            if ((!bLastLine &&currentPart.size() == notifyPerLines) || bLastLine) {
+                postIndexData(currentPart, bLastLine);
+            }
+            return true;
+        }, contentNone, fromPosition);
+    }
+
+    qCDebug(logicDocument) << "xFileProcessor: rebuilding file " << fileName << " done in " << et.elapsed() << " ms, " << throughput(nProcessedTo - fromPosition, et.elapsed()) << " MB/s";
 
     setProgress(100);
 }
 
-void    xFileProcessor::createFilter(QString fileName, QByteArray codecName, filterRules filter, int notifyPerLines, int blockSize) {
+xFileProcessor::operationResult    xFileProcessor::createIndexParallel(const QString & fileName, int notifyPerLines, quint64 * pProcessedTo) {
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return unableToOpenFile;
+    }
+
+    quint64 totalSize = f.size();
+    int     nWorkers  = m_indexWorkers;
+
+    if (!m_useMemoryMapping || f.isSequential() || (nWorkers < 2) || (totalSize < m_parallelIndexThreshold)) {
+        return unableToMapFile;
+    }
+
+    uchar * pMapped = f.map(0, totalSize);
+    if (!pMapped) {
+        return unableToMapFile;
+    }
+
+    adviseSequentialAccess(pMapped, totalSize);
+
+    const char *    pData      = (const char *)pMapped;
+    quint64         chunkSize  = qBound<quint64>(m_parallelChunkMinSize, totalSize / (nWorkers * 8), m_parallelChunkMaxSize);
+    int             nChunks    = (totalSize + chunkSize - 1) / chunkSize;
+    int             nWindow    = nWorkers * 2;
+
+    m_indexPool->setMaxThreadCount(nWorkers);
+
+    qCDebug(logicDocument) << "xFileProcessor: indexing " << fileName << " with " << nWorkers << " workers, " << nChunks << " chunks";
+
+    QVector< QFuture< QVector<quint64> > >  chunks(nChunks);
+
+    auto scheduleChunk = [this, &chunks, pData, chunkSize, totalSize](int nChunk) {
+        quint64 from = nChunk * chunkSize;
+        quint64 to   = qMin(from + chunkSize, totalSize);
+        chunks[nChunk] = QtConcurrent::run(m_indexPool, [this, pData, from, to]() {
+            return scanLineStarts(pData, from, to);
+        });
+    };
+
+    for (int i = 0; i < qMin(nWindow, nChunks); i++) {
+        scheduleChunk(i);
+    }
+
+    linesData       currentPart;
+    quint64         nCurrentLineStart = 0;
+    operationResult result            = requestCompleted;
+
+    for (int i = 0; i < nChunks; i++) {
+        const QVector<quint64>  lineStarts = chunks[i].result();
+
+        result = interruptionState();
+        if (result != requestCompleted) {
+            for (int j = i + 1; j < qMin(i + nWindow, nChunks); j++) {
+                chunks[j].waitForFinished();
+            }
+            break;
+        }
+
+        if (i + nWindow < nChunks) {
+            scheduleChunk(i + nWindow);
+        }
+
+        chunks[i] = QFuture< QVector<quint64> >();
+
+        for (quint64 nNextLineStart : lineStarts) {
+            currentPart << lineData{ nCurrentLineStart, (int)(nNextLineStart - nCurrentLineStart) };
+            nCurrentLineStart = nNextLineStart;
+
+            if (currentPart.size() == notifyPerLines) {
+                postIndexData(currentPart, false);
+            }
+        }
+
+        setProgress(100.*(double)qMin((i + 1) * chunkSize, totalSize) / (double)totalSize);
+    }
+
+    if (result == requestCompleted) {
+        currentPart << lineData{ nCurrentLineStart, (int)(totalSize - nCurrentLineStart) };
+        postIndexData(currentPart, true);
+    }
+
+    *pProcessedTo = (result == requestCompleted) ? totalSize : nCurrentLineStart;
+
+    f.unmap(pMapped);
+
+    return result;
+}
+
+QVector<quint64>    xFileProcessor::scanLineStarts(const char * pData, quint64 from, quint64 to) const {
+    QVector<quint64>    lineStarts;
+
+    const char * pEnd   = pData + to;
+    const char * pBlock = pData + from;
+
+    while (pBlock < pEnd) {
+        if (interruptionState() != requestCompleted)
+            break;
+
+        const char * pBlockEnd = pBlock + qMin<quint64>(m_parallelCheckInterval, pEnd - pBlock);
+        const char * pNewline  = pBlock;
+
+        while ((pNewline = xLineScanner::findNewline(pNewline, pBlockEnd)) != pBlockEnd) {
+            pNewline++;
+            lineStarts << (quint64)(pNewline - pData);
+        }
+
+        pBlock = pBlockEnd;
+    }
+
+    return lineStarts;
+}
+
+void    xFileProcessor::createFilter(QString fileName, QByteArray codecName, filterRules filter, searchRange from, int requestId, int notifyPerLines, int blockSize) {
     BusyFlag    busy(m_busyFlag);
 
     setProgress(0);
 
-    documentIndex    currentPart;
+    filterLines     currentPart;
     QElapsedTimer   et;
     et.start();
-    int              nFilterLines = 0;
 
     QTextCodec * pCodec = QTextCodec::codecForName(codecName);
     if (!pCodec) {
         pCodec = QTextCodec::codecForLocale();
     }
 
+    // literals of same kind are compiled into one automaton and checked on
+    // every line, so their matches are complete and kept apart for document
+    // to combine later without reading file again; other rules run as one
+    // plan with short circuit and only on lines all literals have passed
 
-    processPerLine(fileName, pCodec, blockSize, [this, &currentPart, &filter, notifyPerLines, &nFilterLines](quint64 /*startPosition*/, int /*lineLength*/, int lineNumber, const QString & content, bool bLastLine) {
-        if (checkFilters(content, filter)) {
-            currentPart.forwardIndex[lineNumber]   = nFilterLines;
-            currentPart.reverseIndex[nFilterLines] = lineNumber;
-            nFilterLines++;
+    QVector<searchRequestItem>  requests;
+    QVector<xByteMatcher>       byteMatchers;
+    filterRules                 rules;
 
-            if ((!bLastLine &&currentPart.forwardIndex.size() == notifyPerLines) || bLastLine) {
-                emit filterDataReady(currentPart, bLastLine);
-                currentPart = documentIndex();
+    for (const filterRule & rule : filter) {
+        if (!rule.isActive)
+            continue;
+
+        requests     << rule.filter;
+        byteMatchers << xByteMatcher(rule.filter, pCodec);
+        rules        << rule;
+    }
+
+    QVector<int>    byteLiteralRules;
+    QVector<int>    textLiteralRules;
+    QVector<int>    otherRules;
+
+    for (int i = 0; i < requests.size(); i++) {
+        if (requests[i].type != PatternSearch)
+            otherRules << i;
+        else if (byteMatchers[i].isValid())
+            byteLiteralRules << i;
+        else if (!requests[i].matcher.pattern().isEmpty())
+            textLiteralRules << i;
+        else
+            otherRules << i;
+    }
+
+    xMultiMatcher   byteLiterals;
+    xMultiMatcher   textLiterals;
+
+    if (byteLiteralRules.size() > 1) {
+        for (int i : byteLiteralRules) {
+            byteLiterals.addPattern(byteMatchers[i].pattern(), byteMatchers[i].caseSensitivity());
+        }
+        byteLiterals.build();
+    }
+    else {
+        otherRules += byteLiteralRules;
+        byteLiteralRules.clear();
+    }
+
+    if (textLiteralRules.size() > 1) {
+        for (int i : textLiteralRules) {
+            textLiterals.addPattern(requests[i].matcher.pattern(), requests[i].matcher.caseSensitivity());
+        }
+        textLiterals.build();
+    }
+    else {
+        otherRules += textLiteralRules;
+        textLiteralRules.clear();
+    }
+
+    filterRules otherFilter;
+    for (int i : otherRules) {
+        otherFilter << rules.at(i);
+    }
+
+    xFilterPlan plan(otherFilter, pCodec);
+
+    // matches of rule are complete only if it is evaluated on every line,
+    // that is literal in automaton or single plan rule with no literal
+    // before it, rest is reported as unknown
+
+    QVector<bool>   complete(requests.size(), false);
+    int             nPlanRule = -1;
+
+    for (int i : byteLiteralRules + textLiteralRules) {
+        complete[i] = true;
+    }
+
+    if (byteLiteralRules.isEmpty() && textLiteralRules.isEmpty() && (otherRules.size() == 1)) {
+        nPlanRule = otherRules.first();
+        complete[nPlanRule] = true;
+    }
+
+    QVector<xLineBitmap>        matches(requests.size());
+    QVarLengthArray<bool, 32>   literalFound(requests.size());
+
+    quint64 nProcessedTo = from.position;
+
+    operationResult result = processPerLine(fileName, pCodec, blockSize, [this, &currentPart, &plan, &nPlanRule, &byteLiteralRules, &textLiteralRules, &byteLiterals, &textLiterals, &matches, &literalFound, &from, &nProcessedTo, pCodec, notifyPerLines](quint64 startPosition, int lineLength, qint64 lineNumber, const char * pRaw, const QString & /* content */, bool bLastLine) {
+        qint64  nLine    = from.lineNumber + lineNumber;
+        nProcessedTo     = startPosition + lineLength;
+        bool    bMatched = true;
+        QString text;
+
+        if (!byteLiteralRules.isEmpty()) {
+            byteLiterals.matchingPatterns(pRaw, lineLength, literalFound.data());
+            for (int i = 0; i < byteLiteralRules.size(); i++) {
+                if (literalFound[i])
+                    matches[byteLiteralRules[i]].append(nLine);
+                else
+                    bMatched = false;
+            }
+        }
+
+        if (!textLiteralRules.isEmpty()) {
+            text = pCodec->toUnicode(pRaw, lineLength);
+            textLiterals.matchingPatterns(text, literalFound.data());
+            for (int i = 0; i < textLiteralRules.size(); i++) {
+                if (literalFound[i])
+                    matches[textLiteralRules[i]].append(nLine);
+                else
+                    bMatched = false;
+            }
+        }
+
+        if (bMatched) {
+            bMatched = plan.matches(pRaw, lineLength, text);
+
+            if (bMatched && (nPlanRule != -1))
+                matches[nPlanRule].append(nLine);
+        }
+
+        if (bMatched) {
+            currentPart << nLine;
+
+            if ((!bLastLine &&currentPart.size() == notifyPerLines) || bLastLine) {
+                postFilterData(currentPart, bLastLine);
             }
         } else{
             if (bLastLine) {
-                emit filterDataReady(currentPart, bLastLine);
-                currentPart = documentIndex();
+                postFilterData(currentPart, bLastLine);
             }
         }
         return true;
-    }, true);
+    }, contentRaw, from.position);
+
+    if ((result == requestCompleted) && !requests.isEmpty()) {
+        emit filterRulesMatched(requestId, matches, complete);
+    }
 
     setProgress(100);
 
-    qCDebug(logicDocument) << "xFileProcessor: create filter in file " << fileName << " done in " << et.elapsed() << " ms";    
+    qCDebug(logicDocument) << "xFileProcessor: create filter in file " << fileName << " done in " << et.elapsed() << " ms, " << throughput(nProcessedTo - from.position, et.elapsed()) << " MB/s";
+}
+
+void    xFileProcessor::narrowFilter(QString fileName, QByteArray codecName, filterRules filter, xFilterIndex previous, xLineIndex index, int notifyPerLines, int blockSize) {
+    BusyFlag    busy(m_busyFlag);
+
+    setProgress(0);
+
+    filterLines     currentPart;
+    QElapsedTimer   et;
+    et.start();
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QTextCodec * pCodec = QTextCodec::codecForName(codecName);
+    if (!pCodec) {
+        pCodec = QTextCodec::codecForLocale();
+    }
+
+    xFilterPlan plan(filter, pCodec);
+
+    // only lines passed previous filter are read, exactly as index knows
+    // them; lines close to each other are merged into one read while
+    // gap between them stays small and read fits into block
+
+    QByteArray  block;
+    qint64      nLines   = previous.size();
+    qint64      nChecked = 0;
+    qint64      i        = 0;
+    quint64     nRead    = 0;
+
+    while (i < nLines) {
+        if (interruptionState() != requestCompleted)
+            return;
+
+        qint64  nFirst      = i;
+        quint64 nReadFrom   = 0;
+        int     nLength     = 0;
+        index.line(previous.sourceLine(i), &nReadFrom, &nLength);
+
+        quint64 nReadTo     = nReadFrom + nLength;
+
+        for (i++; i < nLines; i++) {
+            quint64 nPosition = 0;
+            index.line(previous.sourceLine(i), &nPosition, &nLength);
+
+            if ((nPosition - nReadTo > narrowMergeGap) || (nPosition + nLength - nReadFrom > (quint64)blockSize))
+                break;
+
+            nReadTo = nPosition + nLength;
+        }
+
+        f.seek(nReadFrom);
+        block = f.read(nReadTo - nReadFrom);
+        nRead += block.size();
+
+        for (qint64 j = nFirst; j < i; j++) {
+            qint64  nLine     = previous.sourceLine(j);
+            quint64 nPosition = 0;
+            index.line(nLine, &nPosition, &nLength);
+
+            quint64 nOffset = nPosition - nReadFrom;
+            if (nOffset + nLength > (quint64)block.size())
+                break;
+
+            QString text;
+            if (plan.matches(block.constData() + nOffset, nLength, text)) {
+                currentPart << nLine;
+
+                if (currentPart.size() == notifyPerLines) {
+                    postFilterData(currentPart, false);
+                }
+            }
+        }
+
+        if ((nChecked / notifyPerLines) != (i / notifyPerLines)) {
+            setProgress(100. * (double)i / (double)nLines);
+        }
+        nChecked = i;
+    }
+
+    postFilterData(currentPart, true);
+
+    setProgress(100);
+
+    qCDebug(logicDocument) << "xFileProcessor: narrow filter in file " << fileName << " by " << previous.size() << " lines done in " << et.elapsed() << " ms, " << throughput(nRead, et.elapsed()) << " MB/s";
 }
 
 void xFileProcessor::doFileWatch() {
-    linesData    currentPart;
+    indexBatch   currentPart;
+    bool         bRules = m_watchFilterId || m_watchSearchId;
 
-    processPerLine(m_watchFileName, nullptr, m_watchBlockSize, [this, &currentPart](quint64 startPosition, int lineLength, int /*lineNumber*/, const QString & /* content */, bool bLastLine) {
+    processPerLine(m_watchFileName, nullptr, m_watchBlockSize, [this, &currentPart](quint64 startPosition, int lineLength, qint64 /*lineNumber*/, const char * pRaw, const QString & /* content */, bool bLastLine) {
 
         if ((lineLength > 0) && (m_watchLastKnownLine != lineData{startPosition, lineLength})) {
-            currentPart << lineData{ startPosition, lineLength };
+            currentPart.data << lineData{ startPosition, lineLength };
+            matchWatchLine(startPosition, lineLength, pRaw, true, true, currentPart);
         }
 
         m_watchLastKnownLine = lineData{ startPosition, lineLength };
 
-        if ((!bLastLine &&currentPart.size() == m_watchNotifyPerLine) || (bLastLine && currentPart.size())) {
-            emit indexDataReady(currentPart, bLastLine);
-            currentPart.clear();
+        if ((!bLastLine &&currentPart.data.size() == m_watchNotifyPerLine) || (bLastLine && currentPart.data.size())) {
+            postWatchData(currentPart, bLastLine);
         }
         return true;
-    }, false, m_watchLastKnownLine.position, false);
+    }, bRules ? contentRaw : contentNone, m_watchLastKnownLine.position, false);
+}
+
+void xFileProcessor::catchUpWatch(quint64 fromPosition, bool bFilter, bool bSearch) {
+    quint64 nWatchEnd = m_watchLastKnownLine.position + m_watchLastKnownLine.length;
+    if (!m_watchEnabled || (fromPosition >= nWatchEnd))
+        return;
+
+    // lines document got from watch before rules were set are checked
+    // here, the rest is checked by watch itself as it reads them
+
+    indexBatch  currentPart;
+
+    processPerLine(m_watchFileName, nullptr, m_watchBlockSize, [this, &currentPart, nWatchEnd, bFilter, bSearch](quint64 startPosition, int lineLength, qint64 /*lineNumber*/, const char * pRaw, const QString & /* content */, bool /* bLastLine */) {
+        if (startPosition >= nWatchEnd)
+            return false;
+
+        if (lineLength > 0) {
+            matchWatchLine(startPosition, lineLength, pRaw, bFilter, bSearch, currentPart);
+        }
+        return true;
+    }, contentRaw, fromPosition, false);
+
+    if (!currentPart.filterMatches.isEmpty() || !currentPart.searchMatches.isEmpty()) {
+        postWatchData(currentPart, false);
+    }
+}
+
+void xFileProcessor::matchWatchLine(quint64 position, int length, const char * pRaw, bool bFilter, bool bSearch, indexBatch & batch) {
+    if (bFilter && m_watchFilterId) {
+        QString text;
+
+        if (m_watchFilter.matches(pRaw, length, text)) {
+            batch.filterMatches << position;
+        }
+    }
+
+    if (bSearch && m_watchSearchId) {
+        QString text;
+        int     nMatchLength = matchLine(pRaw, length, m_watchSearchCodec, m_watchSearch.request, m_watchSearch.byteMatcher, m_watchSearch.prefilter, text, &m_watchSearch.plan);
+
+        if (nMatchLength) {
+            searchResult item;
+            item.position    = position;
+            item.lineNumber  = -1;
+            item.matchLength = nMatchLength;
+
+            batch.searchMatches << item;
+        }
+    }
+}
+
+xFileProcessor::watchRule xFileProcessor::compileWatchRule(const searchRequestItem & request, QTextCodec * pCodec) const {
+    watchRule   rule;
+    rule.request     = request;
+    rule.prefilter   = (request.type == RegExpSearch) ? xRegExpPrefilter::prefilterItem(request.regexp) : searchRequestItem();
+    rule.byteMatcher = (request.type == RegExpSearch) ? xByteMatcher(rule.prefilter, pCodec) : xByteMatcher(request, pCodec);
+    rule.plan        = (request.type == ExpressionSearch) ? xFilterPlan(request, pCodec) : xFilterPlan();
+    return rule;
 }
 
-xFileProcessor::operationResult    xFileProcessor::processPerLine(const QString & fileName, QTextCodec * pCodec, int blockSize, LineProcessFunction method, bool bTextRequired, quint64 startFromPosition, bool bProgress) {
+xFileProcessor::operationResult    xFileProcessor::processPerLine(const QString & fileName, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content, quint64 startFromPosition, bool bProgress) {
     QFile f(fileName);
     if (!f.open(QIODevice::ReadOnly)) {
         return unableToOpenFile;
     }
 
+    quint64 totalSize = f.size();
+
+    if (m_useMemoryMapping && !f.isSequential() && (totalSize > startFromPosition)) {
+        uchar * pMapped = f.map(startFromPosition, totalSize - startFromPosition);
+        if (pMapped) {
+            adviseSequentialAccess(pMapped, totalSize - startFromPosition);
+
+            operationResult result = processPerLineMapped((const char *)pMapped, totalSize - startFromPosition, pCodec, blockSize, method, content, startFromPosition, bProgress);
+
+            f.unmap(pMapped);
+            return result;
+        }
+
+        qCDebug(logicDocument) << "xFileProcessor: unable to map file " << fileName << ", falling back to buffered read";
+    }
+
+    return processPerLineBuffered(f, pCodec, blockSize, method, content, startFromPosition, bProgress);
+}
+
+xFileProcessor::operationResult    xFileProcessor::processPerLineMapped(const char * pData, quint64 dataSize, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content, quint64 startFromPosition, bool bProgress) {
+    const char *    pEnd               = pData + dataSize;
+    const char *    pBlock             = pData;
+    const char *    pLine              = pData;
+    qint64          nCurrentLineNumber = 0;
+
+    quint64 totalSize = startFromPosition + dataSize;
+
+    while (pBlock < pEnd) {
+        operationResult state = interruptionState();
+        if (state != requestCompleted)
+            return state;
+
+        if (bProgress)
+            setProgress(100.*(double)(startFromPosition + (pBlock - pData)) / (double)totalSize);
+
+        const char * pBlockEnd = pBlock + qMin<quint64>(blockSize, pEnd - pBlock);
+        const char * pNewline  = pBlock;
+
+        while ((pNewline = xLineScanner::findNewline(pNewline, pBlockEnd)) != pBlockEnd) {
+            int     nLineLength = pNewline - pLine + 1;
+            QString text;
+
+            if (content == contentText) {
+                text = pCodec->toUnicode(pLine, nLineLength);
+            }
+
+            if (!method(startFromPosition + (pLine - pData), nLineLength, nCurrentLineNumber, (content != contentNone) ? pLine : nullptr, text, (pNewline == (pEnd - 1)))) {
+                return requestCompleted;
+            }
+
+            nCurrentLineNumber++;
+            pLine = ++pNewline;
+        }
+
+        pBlock = pBlockEnd;
+    }
+
+    QString text;
+
+    if (content == contentText) {
+        text = pCodec->toUnicode(pLine, pEnd - pLine);
+    }
+
+    method(startFromPosition + (pLine - pData), pEnd - pLine, nCurrentLineNumber, (content != contentNone) ? pLine : nullptr, text, true);
+
+    return requestCompleted;
+}
+
+void    xFileProcessor::adviseSequentialAccess(uchar * pData, quint64 size) {
+#ifdef Q_OS_UNIX
+    static const quintptr pageSize = sysconf(_SC_PAGESIZE);
+
+    quintptr alignedStart = ((quintptr)pData) & ~(pageSize - 1);
+    madvise((void *)alignedStart, size + ((quintptr)pData - alignedStart), MADV_SEQUENTIAL);
+#else
+    Q_UNUSED(pData);
+    Q_UNUSED(size);
+#endif
+}
+
+xFileProcessor::operationResult    xFileProcessor::processPerLineBuffered(QFile & f, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content, quint64 startFromPosition, bool bProgress) {
     QByteArray          block;
-    block.reserve(blockSize);
-    quint64 nCurrentPosition  = startFromPosition;
-    quint64 nCurrentLineStart = startFromPosition;
-    quint64 blockStart        = startFromPosition;
-    quint32 nBytesReaded = 0;
-    int     nCurrentLineLength = 0;
-    int     nCurrentLineNumber = 0;
+    block.resize(blockSize);
+    quint64 nCurrentLineStart  = startFromPosition;
+    qint64  nBytesReaded       = 0;
+    qint64  nCurrentLineNumber = 0;
 
     bool    bAtEnd = false;
 
@@ -247,76 +1185,93 @@ xFileProcessor::operationResult    xFileProcessor::processPerLine(const QString
     f.seek(startFromPosition);
 
     QByteArray  lineTail;
+    int         nTailLength = 0;
 
-    do {       
-        nCurrentLineLength  = lineTail.size();
+    do {
+        operationResult state = interruptionState();
+        if (state != requestCompleted)
+            return state;
+
+        if (bProgress)
+            setProgress(100.*(double)nCurrentLineStart / (double)totalSize);
 
-        blockStart          = f.pos();
         nBytesReaded        = f.read(block.data(), blockSize);
-        bAtEnd              = f.atEnd();
-        
-        int currentProgress = 100.*(double)nCurrentPosition / (double)totalSize;
+        bAtEnd              = f.atEnd() || (nBytesReaded <= 0);
 
-        if (bProgress)
-            setProgress(currentProgress);
-        
-        for (quint32 i = 0; i < nBytesReaded; i++) {
-            if (m_shutdownFlag)
-                return systemInterrupted;
-
-            if (m_interrupt) {
-                m_interrupt = 0;
-                return userInterrupted;
-            }
-        
-            nCurrentLineLength++;
-            if (*(block.constData() + i) == 0x0A) {
-                QString text;
-
-                if (bTextRequired) {
-                    if (lineTail.size()) {
-                        lineTail.append((const char*)block.constData(), i+1);
-                        text = pCodec->toUnicode(lineTail, lineTail.size());
-                        lineTail.clear();
-                    }
-                    else {
-                        text = pCodec->toUnicode((block.constData() + nCurrentLineStart - blockStart), nCurrentLineLength);
-                    }
+        if (nBytesReaded < 0)
+            nBytesReaded = 0;
+
+        const char * pBlockEnd = block.constData() + nBytesReaded;
+        const char * pLine     = block.constData();
+        const char * pNewline  = pLine;
+
+        while ((pNewline = xLineScanner::findNewline(pLine, pBlockEnd)) != pBlockEnd) {
+            int             nLineLength = nTailLength + (pNewline - pLine) + 1;
+            const char *    pRaw        = nullptr;
+            QString         text;
+
+            if (content != contentNone) {
+
+                // line started in previous block, it is collected in tail buffer
+
+                if (nTailLength) {
+                    lineTail.append(pLine, pNewline - pLine + 1);
+                    pRaw = lineTail.constData();
+                }
+                else {
+                    pRaw = pLine;
                 }
 
-                if (!method(nCurrentLineStart, nCurrentLineLength, nCurrentLineNumber, text, (bAtEnd && (i == (nBytesReaded - 1))))) {
-                    return requestCompleted;
+                if (content == contentText) {
+                    text = pCodec->toUnicode(pRaw, nLineLength);
                 }
+            }
+
+            nTailLength = 0;
 
-                nCurrentLineNumber++;
-                nCurrentLineStart  = nCurrentPosition + 1;
-                nCurrentLineLength = 0;
+            if (!method(nCurrentLineStart, nLineLength, nCurrentLineNumber, pRaw, text, (bAtEnd && (pNewline == (pBlockEnd - 1))))) {
+                return requestCompleted;
             }
 
-            nCurrentPosition++;
+            lineTail.clear();
+
+            nCurrentLineNumber++;
+            nCurrentLineStart += nLineLength;
+            pLine = pNewline + 1;
         }
 
         if (!bAtEnd) {
-            if (nCurrentLineLength) {
-                lineTail = QByteArray((const char *)(block.constData() + nBytesReaded - nCurrentLineLength - 1), nCurrentLineLength);
+            if (content != contentNone) {
+                lineTail.append(pLine, pBlockEnd - pLine);
             }
+            nTailLength += pBlockEnd - pLine;
         }
         else {
-            QString text;
+            const char *    pRaw = nullptr;
+            QString         text;
 
-            if (bTextRequired) {
-                if (lineTail.size()) {
-                    lineTail.append((block.constData() + nCurrentLineStart - blockStart), nCurrentLineLength);
-                    text = pCodec->toUnicode(lineTail, lineTail.size());
-                }
-                else {
-                    text = pCodec->toUnicode((block.constData() + nCurrentLineStart - blockStart), nCurrentLineLength);
-                }
+            if (content != contentNone) {
+                lineTail.append(pLine, pBlockEnd - pLine);
+                pRaw = lineTail.constData();
+            }
+
+            if (content == contentText) {
+                text = pCodec->toUnicode(lineTail.constData(), lineTail.size());
             }
 
-            method(nCurrentLineStart, nCurrentLineLength, nCurrentLineNumber, text, true);
+            method(nCurrentLineStart, nTailLength + (pBlockEnd - pLine), nCurrentLineNumber, pRaw, text, true);
         }
-    } while (!bAtEnd); 
+    } while (!bAtEnd);
+
+    return requestCompleted;
+}
+
+xFileProcessor::operationResult    xFileProcessor::interruptionState() const {
+    if (m_shutdownFlag)
+        return systemInterrupted;
+
+    if (m_interrupt)
+        return userInterrupted;
 
     return requestCompleted;
 }
@@ -341,6 +1296,34 @@ void    xFileProcessor::disableWatch() {
     m_watchEnabled = 0;
 }
 
+void    xFileProcessor::setWatchFilter(QByteArray codecName, filterRules filter, int rulesId, quint64 fromPosition) {
+    QTextCodec * pCodec = QTextCodec::codecForName(codecName);
+    if (!pCodec) {
+        pCodec = QTextCodec::codecForLocale();
+    }
+
+    m_watchFilter   = xFilterPlan(filter, pCodec);
+    m_watchFilterId = rulesId;
+
+    if (rulesId) {
+        catchUpWatch(fromPosition, true, false);
+    }
+}
+
+void    xFileProcessor::setWatchSearch(QByteArray codecName, searchRequestItem request, int rulesId, quint64 fromPosition) {
+    m_watchSearchCodec = QTextCodec::codecForName(codecName);
+    if (!m_watchSearchCodec) {
+        m_watchSearchCodec = QTextCodec::codecForLocale();
+    }
+
+    m_watchSearch   = compileWatchRule(request, m_watchSearchCodec);
+    m_watchSearchId = request.isValid() ? rulesId : 0;
+
+    if (m_watchSearchId) {
+        catchUpWatch(fromPosition, false, true);
+    }
+}
+
 int xFileProcessor::isWatchEnabled() const {
     return m_watchEnabled;
 }
@@ -355,21 +1338,45 @@ void    xFileProcessor::timerEvent(QTimerEvent * pEvent) {
     }
 }
 
-bool    xFileProcessor::checkFilters(const QString & text, const filterRules & filter) {
-    
-    bool bFound = true;
+int     xFileProcessor::matchLine(const char * pRaw, int length, QTextCodec * pCodec, const searchRequestItem & request, const xByteMatcher & byteMatcher, const searchRequestItem & prefilter, QString & text, xFilterPlan * pPlan) {
 
-    for (const filterRule & rule : filter) {
-        if (!rule.isActive)
-            continue;
+    // expression runs as plan, its literals are checked on raw bytes and
+    // line is decoded only if some step needs text or whole line matches
 
-        bFound &= (checkSearchItem(text, rule.filter) > 0);
+    if ((request.type == ExpressionSearch) && pPlan) {
+        if (!pPlan->matches(pRaw, length, text))
+            return 0;
 
-        if (!bFound)
-            return false;            
+        if (text.isNull()) {
+            text = pCodec->toUnicode(pRaw, length);
+        }
+        return qMax(1, text.size());
+    }
+
+    // byte matcher is either request itself or literal required by regexp,
+    // text is decoded here only if regexp has to be run on it
+
+    if (byteMatcher.isValid()) {
+        if (byteMatcher.indexIn(pRaw, length) == -1)
+            return 0;
+
+        if (request.type == PatternSearch)
+            return byteMatcher.matchLength();
+
+        if (text.isNull()) {
+            text = pCodec->toUnicode(pRaw, length);
+        }
+        return checkSearchItem(text, request);
     }
 
-    return true;
+    if (text.isNull()) {
+        text = pCodec->toUnicode(pRaw, length);
+    }
+
+    if (prefilter.isValid() && (prefilter.matcher.indexIn(text, 0) == -1))
+        return 0;
+
+    return checkSearchItem(text, request);
 }
 
 int    xFileProcessor::checkSearchItem(const QString & text, const searchRequestItem & item) {
@@ -386,6 +1393,13 @@ int    xFileProcessor::checkSearchItem(const QString & text, const searchRequest
             return i.next().capturedLength();
         }
     }
+    else if (item.type == ExpressionSearch) {
+
+        // expression has no single match, whole line is reported
+
+        if (item.compiled && item.compiled->matches(text))
+            return qMax(1, text.size());
+    }
 
     return 0;
 }
@@ -396,6 +1410,52 @@ void    xFileProcessor::interrupt() {
     m_interrupt = 0;
 }
 
+void    xFileProcessor::postIndexData(linesData & data, bool bCompleted) {
+    indexBatch  batch;
+    batch.data       = std::move(data);
+    batch.bCompleted = bCompleted;
+    data.clear();
+
+    if (m_indexQueue.push(std::move(batch))) {
+        emit dataAvailable();
+    }
+}
+
+void    xFileProcessor::postWatchData(indexBatch & batch, bool bCompleted) {
+    batch.bCompleted    = bCompleted;
+    batch.filterRulesId = m_watchFilterId;
+    batch.searchRulesId = m_watchSearchId;
+
+    bool bPushed = m_indexQueue.push(std::move(batch));
+    batch = indexBatch();
+
+    if (bPushed) {
+        emit dataAvailable();
+    }
+}
+
+void    xFileProcessor::postFilterData(filterLines & data, bool bCompleted) {
+    filterBatch batch;
+    batch.data       = std::move(data);
+    batch.bCompleted = bCompleted;
+    data = filterLines();
+
+    if (m_filterQueue.push(std::move(batch))) {
+        emit dataAvailable();
+    }
+}
+
+void    xFileProcessor::postSearchResults(searchResults & data, bool bCompleted) {
+    searchBatch batch;
+    batch.data       = std::move(data);
+    batch.bCompleted = bCompleted;
+    data.clear();
+
+    if (m_searchQueue.push(std::move(batch))) {
+        emit dataAvailable();
+    }
+}
+
 void    xFileProcessor::setProgress(int value) {
     if (m_currentProgress == value)
         return;
@@ -25,10 +25,15 @@
 
 #include <QObject>
 #include <QThread>
+#include <QFuture>
 
 #include "xdocument.h"
+#include "xspscqueue.h"
+#include "xbytematcher.h"
+#include "xfilterplan.h"
 
 class xFileProcessorThread;
+class QThreadPool;
 
 class   BusyFlag {
 public:
@@ -45,7 +50,26 @@ protected:
     QAtomicInt &    m_flag;
 };
 
-typedef std::function<bool(quint64 startPosition, int lineLength, int lineNumber, const QString & content, bool bLastLine)> LineProcessFunction;
+template <typename T> struct processorBatch {
+    T       data;
+    bool    bCompleted = false;
+};
+
+// batch posted by file watch also carries positions of appended lines
+// matching live filter and search, tagged with id of rules they were
+// checked with, so document drops matches of rules replaced meanwhile
+
+struct indexBatch : processorBatch<linesData> {
+    QVector<quint64>    filterMatches;
+    searchResults       searchMatches;
+    int                 filterRulesId = 0;
+    int                 searchRulesId = 0;
+};
+
+typedef processorBatch<filterLines>     filterBatch;
+typedef processorBatch<searchResults>   searchBatch;
+
+typedef std::function<bool(quint64 startPosition, int lineLength, qint64 lineNumber, const char * pRaw, const QString & content, bool bLastLine)> LineProcessFunction;
 
 class	xFileProcessor: public QObject {
 	Q_OBJECT
@@ -55,7 +79,17 @@ public:
         requestCompleted   = 0,
         unableToOpenFile   = 1,
         userInterrupted    = 2,
-        systemInterrupted  = 3
+        systemInterrupted  = 3,
+        unableToMapFile    = 4
+    };
+
+    // what processPerLine passes to the line method besides position and length,
+    // raw bytes are valid only during the call
+
+    enum lineContent {
+        contentNone        = 0,
+        contentRaw         = 1,
+        contentText        = 2
     };
 
 	xFileProcessor();
@@ -68,21 +102,52 @@ public:
     }
     void    interrupt();
 
-    Q_INVOKABLE void    createIndex(QString fileName, int notifyPerLines, int blockSize);
-    Q_INVOKABLE void    searchData(QString fileName, QByteArray codecName, searchRequestItem request, quint64 fromPosition, int maxOccurencies, int notifyPerLines, int blockSize);
-    Q_INVOKABLE void    createFilter(QString fileName, QByteArray codecName, filterRules filter, int notifyPerLines, int blockSize);
+    void    setIndexWorkers(int nWorkers) {
+        m_indexWorkers = nWorkers;
+    }
+    int     indexWorkers() const {
+        return m_indexWorkers;
+    }
+
+    // density runs of older generation still waiting in queue are skipped
+    void    setDensityGeneration(int generation) {
+        m_densityGeneration = generation;
+    }
+
+    Q_INVOKABLE void    createIndex(QString fileName, quint64 fromPosition, int notifyPerLines, int blockSize);
+    Q_INVOKABLE void    searchData(QString fileName, QByteArray codecName, searchRequestItem request, searchRange from, int maxOccurencies, int notifyPerLines, int blockSize);
+    Q_INVOKABLE void    searchDataParallel(QString fileName, QByteArray codecName, searchRequestItem request, searchRanges ranges, int maxOccurencies, int notifyPerLines, int blockSize);
+    Q_INVOKABLE void    findOccurrence(QString fileName, QByteArray codecName, searchRequestItem request, filterRules filter, quint64 position, bool bBackward, int blockSize);
+    Q_INVOKABLE void    computeDensity(QString fileName, QByteArray codecName, QVector<searchRequestItem> items, quint64 fromPosition, quint64 cellSize, int generation);
+    Q_INVOKABLE void    narrowFilter(QString fileName, QByteArray codecName, filterRules filter, xFilterIndex previous, xLineIndex index, int notifyPerLines, int blockSize);
+    Q_INVOKABLE void    createFilter(QString fileName, QByteArray codecName, filterRules filter, searchRange from, int requestId, int notifyPerLines, int blockSize);
 
     Q_INVOKABLE void    enabledWatch(const QString & fileName, lineData    lastKnownLine, int timeout = 1000);
     Q_INVOKABLE void    disableWatch();
+    Q_INVOKABLE void    setWatchFilter(QByteArray codecName, filterRules filter, int rulesId, quint64 fromPosition);
+    Q_INVOKABLE void    setWatchSearch(QByteArray codecName, searchRequestItem request, int rulesId, quint64 fromPosition);
+
+    static QVector<quint64> createCheckpoints(const QString & fileName, quint64 stride, const QAtomicInt & cancelled);
 
     int isWatchEnabled() const;
     int currentProgress() const;
+
+    xSpscQueue<indexBatch>  *   indexQueue() {
+        return &m_indexQueue;
+    }
+    xSpscQueue<filterBatch> *   filterQueue() {
+        return &m_filterQueue;
+    }
+    xSpscQueue<searchBatch> *   searchQueue() {
+        return &m_searchQueue;
+    }
     
 signals:
 
-    void    indexDataReady(linesData indexData, bool bCompleted);
-    void    filterDataReady(documentIndex indexData, bool bCompleted);
-    void    searchResultsReady(searchResults indexData, bool bCompleted);
+    void    dataAvailable();
+    void    occurrenceFound(searchResult item, bool bFound);
+    void    densityReady(densityData data, bool bCompleted);
+    void    filterRulesMatched(int requestId, QVector<xLineBitmap> matches, QVector<bool> complete);
 
     void    progressChanged(int);
         
@@ -90,12 +155,31 @@ protected:
 
     void    setProgress(int value);
 
-    operationResult    processPerLine(const QString & fileName, QTextCodec * pCodec, int blockSize, LineProcessFunction method, bool bTextRequired = true, quint64 startFromPosition = 0, bool bProgress = true);
+    void    postIndexData(linesData & data, bool bCompleted);
+    void    postWatchData(indexBatch & batch, bool bCompleted);
+    void    postFilterData(filterLines & data, bool bCompleted);
+    void    postSearchResults(searchResults & data, bool bCompleted);
+
+    operationResult    processPerLine(const QString & fileName, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content = contentText, quint64 startFromPosition = 0, bool bProgress = true);
+    operationResult    processPerLineMapped(const char * pData, quint64 dataSize, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content, quint64 startFromPosition, bool bProgress);
+    operationResult    processPerLineBuffered(QFile & f, QTextCodec * pCodec, int blockSize, LineProcessFunction method, lineContent content, quint64 startFromPosition, bool bProgress);
+
+    operationResult    findForward(const QString & fileName, QTextCodec * pCodec, const searchRequestItem & request, xFilterPlan & filterPlan, quint64 position, int blockSize, searchResult * pResult);
+    operationResult    findBackward(const QString & fileName, QTextCodec * pCodec, const searchRequestItem & request, xFilterPlan & filterPlan, quint64 position, int blockSize, searchResult * pResult);
+
+    void    adviseSequentialAccess(uchar * pData, quint64 size);
+    operationResult    interruptionState() const;
+
+    operationResult    createIndexParallel(const QString & fileName, int notifyPerLines, quint64 * pProcessedTo);
+    QVector<quint64>   scanLineStarts(const char * pData, quint64 from, quint64 to) const;
+    searchResults      searchChunk(const char * pData, quint64 from, quint64 to, qint64 firstLine, QTextCodec * pCodec, const searchRequestItem & request, const searchRequestItem & prefilter, const xByteMatcher & byteMatcher, int maxOccurences, int nChunk, const QAtomicInt & stopAfterChunk);
 
-    bool    checkFilters(const QString & text, const filterRules & filter);
     int     checkSearchItem(const QString & text, const searchRequestItem & item);
+    int     matchLine(const char * pRaw, int length, QTextCodec * pCodec, const searchRequestItem & request, const xByteMatcher & byteMatcher, const searchRequestItem & prefilter, QString & text, xFilterPlan * pPlan = nullptr);
 
     void doFileWatch();
+    void catchUpWatch(quint64 fromPosition, bool bFilter, bool bSearch);
+    void matchWatchLine(quint64 position, int length, const char * pRaw, bool bFilter, bool bSearch, indexBatch & batch);
     
     void    init();
     void    done();
@@ -106,17 +190,49 @@ protected:
 
     const           int         m_watchBlockSize     = 1000000;
     const           int         m_watchNotifyPerLine = 1000;
+    const           bool        m_useMemoryMapping   = true;
+
+    const           quint64     m_parallelIndexThreshold = 64 * 1024 * 1024;
+    const           quint64     m_parallelChunkMinSize   = 8 * 1024 * 1024;
+    const           quint64     m_parallelChunkMaxSize   = 256 * 1024 * 1024;
+    const           quint64     m_parallelCheckInterval  = 1024 * 1024;
+
+    const           int         m_densityBlockSize       = 4 * 1024 * 1024;
+    const           int         m_densityNotifyInterval  = 250;
+
+    QAtomicInt                  m_indexWorkers      = 1;
+    QThreadPool     *           m_indexPool         = nullptr;
+
+    xSpscQueue<indexBatch>      m_indexQueue;
+    xSpscQueue<filterBatch>     m_filterQueue;
+    xSpscQueue<searchBatch>     m_searchQueue;
 
     QAtomicInt                  m_currentProgress   = 0;
     QAtomicInt                  m_busyFlag          = 0;
     QAtomicInt                  m_shutdownFlag      = 0; 
     QAtomicInt                  m_interrupt         = 0;
+    QAtomicInt                  m_densityGeneration = 0;
     QAtomicInt                  m_watchEnabled      = 0;
 
     int                         m_watchTimer         = -1;
     lineData                    m_watchLastKnownLine = { 0, 0 };
     QString                     m_watchFileName;
 
+    struct watchRule {
+        searchRequestItem       request;
+        searchRequestItem       prefilter;
+        xByteMatcher            byteMatcher;
+        xFilterPlan             plan;
+    };
+
+    watchRule                   compileWatchRule(const searchRequestItem & request, QTextCodec * pCodec) const;
+
+    xFilterPlan                 m_watchFilter;
+    int                         m_watchFilterId      = 0;
+    QTextCodec      *           m_watchSearchCodec   = nullptr;
+    watchRule                   m_watchSearch;
+    int                         m_watchSearchId      = 0;
+
     friend class                xFileProcessorThread;    
 };
 
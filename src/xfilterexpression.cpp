@@ -0,0 +1,373 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QSharedPointer>
+
+#include "xfilterexpression.h"
+
+searchRequestItem   searchRequestItem::expressionSearch(const QString & expression, QString * pError) {
+    searchRequestItem   item;
+
+    QSharedPointer<xFilterExpression> compiled(new xFilterExpression());
+    if (!compiled->parse(expression)) {
+        if (pError) *pError = compiled->errorString();
+        return item;
+    }
+
+    item.type       = ExpressionSearch;
+    item.expression = expression;
+    item.compiled   = compiled;
+    return item;
+}
+
+xFilterExpression::xFilterExpression() {
+}
+
+xFilterExpression::~xFilterExpression() {
+}
+
+bool    xFilterExpression::parse(const QString & text) {
+    m_tokens.clear();
+    m_nToken = 0;
+    m_nDepth = 0;
+    m_nodes.clear();
+    m_root   = -1;
+    m_text   = text;
+    m_error.clear();
+
+    if (!tokenize(text))
+        return false;
+
+    if (m_tokens.isEmpty()) {
+        m_error = tr("Empty expression");
+        return false;
+    }
+
+    int nRoot = parseExpression();
+    if ((nRoot != -1) && (m_nToken < m_tokens.size())) {
+        m_error = tr("Unexpected '%1'").arg(m_tokens.at(m_nToken).text);
+        nRoot   = -1;
+    }
+
+    m_tokens.clear();
+
+    if (nRoot == -1) {
+        m_nodes.clear();
+        return false;
+    }
+
+    m_root = nRoot;
+    return true;
+}
+
+bool    xFilterExpression::matches(const QString & text) const {
+    if (m_root == -1)
+        return false;
+
+    return matchesNode(m_root, text);
+}
+
+bool    xFilterExpression::tokenize(const QString & text) {
+    int nLength = text.size();
+    int i       = 0;
+
+    while (i < nLength) {
+        QChar   c = text.at(i);
+        token   t;
+
+        if (c.isSpace()) {
+            i++;
+            continue;
+        }
+
+        if ((c == '(') || (c == ')') || (c == '!')) {
+            t.type = (c == '(') ? tokenOpen : ((c == ')') ? tokenClose : tokenNot);
+            t.text = c;
+            m_tokens << t;
+            i++;
+            continue;
+        }
+
+        // quoted text and regexp, backslash escapes closing character,
+        // in regexp any other escape is kept as is; text starting with
+        // slash is regexp only if it is closed at end of token, otherwise
+        // it is a word like path
+
+        if ((c == '"') || (c == '/')) {
+            bool    bClosed = false;
+            QString value;
+            int     nEnd    = i + 1;
+
+            while (nEnd < nLength) {
+                QChar ch = text.at(nEnd++);
+
+                if ((ch == '\\') && (nEnd < nLength)) {
+                    QChar next = text.at(nEnd++);
+                    if ((c == '/') && (next != '/')) {
+                        value += ch;
+                    }
+                    value += next;
+                    continue;
+                }
+
+                if (ch == c) {
+                    bClosed = true;
+                    break;
+                }
+                value += ch;
+            }
+
+            // i right after closing character is flag only if token ends there
+
+            bool bFlag = bClosed && (nEnd < nLength) && (text.at(nEnd) == 'i') && isTokenEnd(text, nEnd + 1);
+
+            if ((c == '"') || (bClosed && !value.isEmpty() && (bFlag || isTokenEnd(text, nEnd)))) {
+                if (!bClosed) {
+                    m_error = tr("Missing closing %1").arg(c);
+                    return false;
+                }
+
+                if (value.isEmpty()) {
+                    m_error = tr("Empty pattern");
+                    return false;
+                }
+
+                t.type = (c == '"') ? tokenPattern : tokenRegExp;
+                t.text = value;
+
+                if (bFlag) {
+                    t.cs = Qt::CaseInsensitive;
+                    nEnd++;
+                }
+
+                m_tokens << t;
+                i = nEnd;
+                continue;
+            }
+        }
+
+        // bare word ends only at whitespace or parenthesis
+
+        int nStart = i;
+        while ((i < nLength) && !text.at(i).isSpace() && (text.at(i) != '(') && (text.at(i) != ')')) {
+            i++;
+        }
+
+        t.text = text.mid(nStart, i - nStart);
+
+        if ((t.text == "AND") || (t.text == "&&"))
+            t.type = tokenAnd;
+        else if ((t.text == "OR") || (t.text == "||"))
+            t.type = tokenOr;
+        else if (t.text == "NOT")
+            t.type = tokenNot;
+        else
+            t.type = tokenWord;
+
+        m_tokens << t;
+    }
+
+    return true;
+}
+
+bool    xFilterExpression::isTokenEnd(const QString & text, int nPosition) {
+    return (nPosition >= text.size()) || text.at(nPosition).isSpace() || (text.at(nPosition) == ')');
+}
+
+bool    xFilterExpression::isFactorStart() const {
+    if (m_nToken >= m_tokens.size())
+        return false;
+
+    switch (m_tokens.at(m_nToken).type) {
+        case tokenWord:
+        case tokenPattern:
+        case tokenRegExp:
+        case tokenNot:
+        case tokenOpen:
+            return true;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+int     xFilterExpression::parseExpression() {
+    QVector<int> children;
+
+    int nChild = parseTerm();
+    if (nChild == -1)
+        return -1;
+    children << nChild;
+
+    while ((m_nToken < m_tokens.size()) && (m_tokens.at(m_nToken).type == tokenOr)) {
+        m_nToken++;
+
+        nChild = parseTerm();
+        if (nChild == -1)
+            return -1;
+        children << nChild;
+    }
+
+    return (children.size() == 1) ? children.first() : addNode(nodeOr, children);
+}
+
+int     xFilterExpression::parseTerm() {
+    QVector<int> children;
+
+    int nChild = parseFactor();
+    if (nChild == -1)
+        return -1;
+    children << nChild;
+
+    while (m_nToken < m_tokens.size()) {
+        if (m_tokens.at(m_nToken).type == tokenAnd) {
+            m_nToken++;
+        }
+        else if (!isFactorStart()) {
+            break;
+        }
+
+        nChild = parseFactor();
+        if (nChild == -1)
+            return -1;
+        children << nChild;
+    }
+
+    return (children.size() == 1) ? children.first() : addNode(nodeAnd, children);
+}
+
+int     xFilterExpression::parseFactor() {
+    if (m_nToken >= m_tokens.size()) {
+        m_error = tr("Unexpected end of expression");
+        return -1;
+    }
+
+    const token t = m_tokens.at(m_nToken++);
+
+    // negation and parentheses nest parser, plan and matching,
+    // so their depth is limited
+
+    if ((t.type == tokenNot) || (t.type == tokenOpen)) {
+        if (m_nDepth >= m_maxDepth) {
+            m_error = tr("Expression is nested too deeply");
+            return -1;
+        }
+    }
+
+    switch (t.type) {
+        case tokenNot: {
+            m_nDepth++;
+            int nChild = parseFactor();
+            m_nDepth--;
+
+            if (nChild == -1)
+                return -1;
+
+            return addNode(nodeNot, QVector<int>() << nChild);
+        }
+
+        case tokenOpen: {
+            m_nDepth++;
+            int nChild = parseExpression();
+            m_nDepth--;
+
+            if (nChild == -1)
+                return -1;
+
+            if ((m_nToken >= m_tokens.size()) || (m_tokens.at(m_nToken).type != tokenClose)) {
+                m_error = tr("Missing closing parenthesis");
+                return -1;
+            }
+
+            m_nToken++;
+            return nChild;
+        }
+
+        case tokenWord:
+        case tokenPattern: {
+            searchRequestItem item = searchRequestItem::patternSearch(t.text);
+            item.matcher.setCaseSensitivity(t.cs);
+
+            return addNode(nodeLeaf, QVector<int>(), item);
+        }
+
+        case tokenRegExp: {
+            searchRequestItem item = searchRequestItem::regexpSearch(t.text);
+            if (t.cs == Qt::CaseInsensitive) {
+                item.regexp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+            }
+
+            if (!item.regexp.isValid()) {
+                m_error = tr("Invalid regular expression /%1/: %2").arg(t.text, item.regexp.errorString());
+                return -1;
+            }
+
+            return addNode(nodeLeaf, QVector<int>(), item);
+        }
+
+        default:
+            break;
+    }
+
+    m_error = tr("Unexpected '%1'").arg(t.text);
+    return -1;
+}
+
+int     xFilterExpression::addNode(nodeType type, const QVector<int> & children, const searchRequestItem & item) {
+    node n;
+    n.type     = type;
+    n.item     = item;
+    n.children = children;
+
+    m_nodes << n;
+    return m_nodes.size() - 1;
+}
+
+bool    xFilterExpression::matchesNode(int nNode, const QString & text) const {
+    const node & n = m_nodes.at(nNode);
+
+    switch (n.type) {
+        case nodeLeaf:
+            if (n.item.type == PatternSearch)
+                return n.item.matcher.indexIn(text, 0) != -1;
+            return n.item.regexp.match(text).hasMatch();
+
+        case nodeAnd:
+            for (int nChild : n.children) {
+                if (!matchesNode(nChild, text))
+                    return false;
+            }
+            return true;
+
+        case nodeOr:
+            for (int nChild : n.children) {
+                if (matchesNode(nChild, text))
+                    return true;
+            }
+            return false;
+
+        case nodeNot:
+            return !matchesNode(n.children.first(), text);
+    }
+
+    return false;
+}
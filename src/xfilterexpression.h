@@ -0,0 +1,129 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#ifndef _xFilterExpression_h_
+#define _xFilterExpression_h_  1
+
+#include <QString>
+#include <QVector>
+#include <QCoreApplication>
+
+#include "xdocument.h"
+
+// boolean filter expression parsed into tree of nodes, leaves are plain
+// search items; grammar:
+//
+//   expression := term { (OR | ||) term }
+//   term       := factor { [AND | &&] factor }
+//   factor     := (NOT | !) factor | ( expression ) | literal
+//   literal    := word | "text" | "text"i | /regexp/ | /regexp/i
+//
+// adjacent factors are joined by AND, literals are case sensitive unless
+// followed by i
+
+class xFilterExpression {
+    Q_DECLARE_TR_FUNCTIONS(xFilterExpression)
+public:
+
+    enum nodeType {
+        nodeLeaf    = 0,
+        nodeAnd     = 1,
+        nodeOr      = 2,
+        nodeNot     = 3
+    };
+
+    struct node {
+        nodeType            type = nodeLeaf;
+        searchRequestItem   item;
+        QVector<int>        children;
+    };
+
+    xFilterExpression();
+    ~xFilterExpression();
+
+    bool            parse(const QString & text);
+
+    bool            isValid() const {
+        return m_root != -1;
+    }
+
+    QString         text() const {
+        return m_text;
+    }
+
+    QString         errorString() const {
+        return m_error;
+    }
+
+    int             root() const {
+        return m_root;
+    }
+
+    const node &    nodeAt(int nNode) const {
+        return m_nodes.at(nNode);
+    }
+
+    bool            matches(const QString & text) const;
+
+protected:
+
+    enum tokenType {
+        tokenWord    = 0,
+        tokenPattern = 1,
+        tokenRegExp  = 2,
+        tokenAnd     = 3,
+        tokenOr      = 4,
+        tokenNot     = 5,
+        tokenOpen    = 6,
+        tokenClose   = 7
+    };
+
+    struct token {
+        tokenType               type = tokenWord;
+        QString                 text;
+        Qt::CaseSensitivity     cs   = Qt::CaseSensitive;
+    };
+
+    bool            tokenize(const QString & text);
+    bool            isFactorStart() const;
+
+    static  bool    isTokenEnd(const QString & text, int nPosition);
+
+    int             parseExpression();
+    int             parseTerm();
+    int             parseFactor();
+    int             addNode(nodeType type, const QVector<int> & children, const searchRequestItem & item = searchRequestItem());
+
+    bool            matchesNode(int nNode, const QString & text) const;
+
+    static  const   int     m_maxDepth = 64;
+
+    QVector<token>  m_tokens;
+    int             m_nToken = 0;
+    int             m_nDepth = 0;
+
+    QVector<node>   m_nodes;
+    int             m_root   = -1;
+    QString         m_text;
+    QString         m_error;
+};
+
+#endif
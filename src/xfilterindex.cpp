@@ -0,0 +1,114 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QtAlgorithms>
+
+#include "xfilterindex.h"
+
+xFilterIndex::xFilterIndex() {
+}
+
+xFilterIndex::~xFilterIndex() {
+}
+
+void    xFilterIndex::clear() {
+    m_lines.clear();
+    m_words.clear();
+    m_ranks.clear();
+}
+
+void    xFilterIndex::append(qint64 sourceLine) {
+    if ((sourceLine < 0) || (sourceLine <= lastSourceLine()))
+        return;
+
+    qint64 nWord = sourceLine >> m_wordShift;
+
+    // words skipped by append have no bits, rank of each is current size
+
+    while (m_words.size() <= nWord) {
+        m_words << 0;
+        m_ranks << m_lines.size();
+    }
+
+    m_words[nWord] |= (quint64)1 << (sourceLine & m_wordMask);
+    m_lines << sourceLine;
+}
+
+void    xFilterIndex::truncate(qint64 sourceLine) {
+    if (sourceLine > lastSourceLine())
+        return;
+
+    qint64 nCount = rank(sourceLine);
+    if (!nCount) {
+        clear();
+        return;
+    }
+
+    m_lines.resize(nCount);
+
+    // bitmap ends with word of last kept line, so ranks of following
+    // words never get stale when appending continues
+
+    qint64 nLast  = m_lines.last();
+    qint64 nWords = (nLast >> m_wordShift) + 1;
+
+    m_words.resize(nWords);
+    m_ranks.resize(nWords);
+    m_words[nWords - 1] &= ((quint64)2 << (nLast & m_wordMask)) - 1;
+}
+
+qint64  xFilterIndex::sourceLine(qint64 line) const {
+    if ((line < 0) || (line >= m_lines.size()))
+        return -1;
+
+    return m_lines.at(line);
+}
+
+qint64  xFilterIndex::filteredLine(qint64 sourceLine) const {
+    if (sourceLine < 0)
+        return -1;
+
+    qint64 nWord = sourceLine >> m_wordShift;
+    if (nWord >= m_words.size())
+        return -1;
+
+    if (!(m_words.at(nWord) & ((quint64)1 << (sourceLine & m_wordMask))))
+        return -1;
+
+    return rank(sourceLine);
+}
+
+qint64  xFilterIndex::rank(qint64 sourceLine) const {
+    if (sourceLine <= 0)
+        return 0;
+
+    qint64 nWord = sourceLine >> m_wordShift;
+    if (nWord >= m_words.size())
+        return m_lines.size();
+
+    quint64 nMask = ((quint64)1 << (sourceLine & m_wordMask)) - 1;
+
+    return m_ranks.at(nWord) + qPopulationCount(m_words.at(nWord) & nMask);
+}
+
+quint64 xFilterIndex::memoryUsage() const {
+    return m_lines.memoryUsage() + m_words.memoryUsage() + m_ranks.memoryUsage();
+}
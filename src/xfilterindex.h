@@ -0,0 +1,75 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xFilterIndex_h_
+#define _xFilterIndex_h_  1
+
+#include "xsegmentedvector.h"
+
+// lines passed filter, kept as sorted vector of source line numbers for
+// filtered to source mapping and as bitmap over source lines with rank per
+// word for reverse one, both lookups are O(1), lines are appended in source
+// order only
+
+class xFilterIndex {
+public:
+
+    xFilterIndex();
+    ~xFilterIndex();
+
+    qint64      size() const {
+        return m_lines.size();
+    }
+
+    bool        isEmpty() const {
+        return m_lines.isEmpty();
+    }
+
+    void        clear();
+    void        append(qint64 sourceLine);
+    void        truncate(qint64 sourceLine);
+
+    qint64      sourceLine(qint64 line) const;
+    qint64      filteredLine(qint64 sourceLine) const;
+    qint64      rank(qint64 sourceLine) const;
+
+    bool        contains(qint64 sourceLine) const {
+        return filteredLine(sourceLine) != -1;
+    }
+
+    qint64      lastSourceLine() const {
+        return m_lines.isEmpty() ? -1 : m_lines.last();
+    }
+
+    quint64     memoryUsage() const;
+
+protected:
+
+    static  const   int         m_wordShift = 6;
+    static  const   int         m_wordMask  = (1 << m_wordShift) - 1;
+
+    xSegmentedVector<qint64, 14>    m_lines;
+    xSegmentedVector<quint64, 12>   m_words;
+    xSegmentedVector<qint64, 12>    m_ranks;
+};
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QTextCodec>
+#include <algorithm>
+
+#include "xfilterplan.h"
+#include "xfilterexpression.h"
+#include "xregexpprefilter.h"
+
+xFilterPlan::xFilterPlan() {
+}
+
+xFilterPlan::xFilterPlan(const filterRules & rules, QTextCodec * pCodec):
+    m_pCodec(pCodec) {
+
+    QVector<int> children;
+    for (const filterRule & rule : rules) {
+        if (rule.isActive) {
+            children << addItem(rule.filter);
+        }
+    }
+
+    if (children.size() > 1) {
+        m_root = addGroup(stepAnd, children);
+    }
+    else if (children.size() == 1) {
+        m_root = children.first();
+    }
+
+    if (m_root != -1) {
+        reorder(m_root);
+    }
+}
+
+xFilterPlan::xFilterPlan(const searchRequestItem & item, QTextCodec * pCodec):
+    m_pCodec(pCodec) {
+    m_root = addItem(item);
+    reorder(m_root);
+}
+
+xFilterPlan::~xFilterPlan() {
+}
+
+bool    xFilterPlan::matches(const char * pRaw, int length, QString & text) {
+    if (m_root == -1)
+        return true;
+
+    bool bMatched = evaluate(m_root, pRaw, length, text);
+
+    if ((++m_nLines % m_reorderInterval) == 0) {
+        reorder(m_root);
+    }
+
+    return bMatched;
+}
+
+int     xFilterPlan::addItem(const searchRequestItem & item) {
+    if (item.type == ExpressionSearch) {
+        if (item.compiled && item.compiled->isValid())
+            return addExpression(*item.compiled, item.compiled->root());
+
+        // broken expression matches nothing
+
+        return addGroup(stepOr, QVector<int>());
+    }
+
+    step s;
+    s.type    = (item.type == RegExpSearch) ? stepRegExp : stepPattern;
+    s.request = item;
+
+    if (item.type == RegExpSearch) {
+        s.prefilter   = xRegExpPrefilter::prefilterItem(item.regexp);
+        s.byteMatcher = xByteMatcher(s.prefilter, m_pCodec);
+        s.cost        = m_regexpCost;
+    }
+    else {
+        s.byteMatcher = xByteMatcher(item, m_pCodec);
+        s.cost        = m_textCost;
+
+        if (s.byteMatcher.isValid()) {
+            s.cost = m_byteCost;
+        }
+    }
+
+    m_steps << s;
+    return m_steps.size() - 1;
+}
+
+int     xFilterPlan::addExpression(const xFilterExpression & expression, int nNode) {
+    const xFilterExpression::node & n = expression.nodeAt(nNode);
+
+    if (n.type == xFilterExpression::nodeLeaf)
+        return addItem(n.item);
+
+    QVector<int> children;
+    for (int nChild : n.children) {
+        children << addExpression(expression, nChild);
+    }
+
+    switch (n.type) {
+        case xFilterExpression::nodeAnd:
+            return addGroup(stepAnd, children);
+        case xFilterExpression::nodeOr:
+            return addGroup(stepOr, children);
+        default:
+            break;
+    }
+
+    return addGroup(stepNot, children);
+}
+
+int     xFilterPlan::addGroup(stepType type, const QVector<int> & children) {
+    step s;
+    s.type     = type;
+    s.children = children;
+
+    m_steps << s;
+    return m_steps.size() - 1;
+}
+
+bool    xFilterPlan::evaluate(int nStep, const char * pRaw, int length, QString & text) {
+    step &  s        = m_steps[nStep];
+    bool    bMatched = false;
+
+    switch (s.type) {
+        case stepPattern:
+        case stepRegExp:
+
+            // byte matcher is either pattern itself or literal required by
+            // regexp, line is decoded only when text has to be checked
+
+            if (s.byteMatcher.isValid()) {
+                bMatched = s.byteMatcher.indexIn(pRaw, length) != -1;
+                if (!bMatched || (s.type == stepPattern))
+                    break;
+            }
+
+            if (text.isNull()) {
+                text = m_pCodec->toUnicode(pRaw, length);
+            }
+
+            if (s.type == stepPattern) {
+                bMatched = s.request.matcher.indexIn(text, 0) != -1;
+            }
+            else if (!s.byteMatcher.isValid() && s.prefilter.isValid() && (s.prefilter.matcher.indexIn(text, 0) == -1)) {
+                bMatched = false;
+            }
+            else {
+                bMatched = s.request.regexp.match(text).hasMatch();
+            }
+            break;
+
+        case stepAnd:
+            bMatched = true;
+            for (int nChild : s.children) {
+                if (!evaluate(nChild, pRaw, length, text)) {
+                    bMatched = false;
+                    break;
+                }
+            }
+            break;
+
+        case stepOr:
+            for (int nChild : s.children) {
+                if (evaluate(nChild, pRaw, length, text)) {
+                    bMatched = true;
+                    break;
+                }
+            }
+            break;
+
+        case stepNot:
+            bMatched = !evaluate(s.children.first(), pRaw, length, text);
+            break;
+    }
+
+    s.evaluated++;
+    if (bMatched) {
+        s.passed++;
+    }
+
+    return bMatched;
+}
+
+double  xFilterPlan::passRate(int nStep) const {
+    const step & s = m_steps.at(nStep);
+
+    // smoothed, so steps not evaluated yet are ordered by cost only
+
+    return (s.passed + 1.) / (s.evaluated + 2.);
+}
+
+void    xFilterPlan::reorder(int nStep) {
+    step & s = m_steps[nStep];
+
+    if ((s.type == stepPattern) || (s.type == stepRegExp))
+        return;
+
+    for (int nChild : s.children) {
+        reorder(nChild);
+    }
+
+    if (s.type == stepNot) {
+        s.cost = m_steps.at(s.children.first()).cost;
+        return;
+    }
+
+    // AND stops on first failed child, OR on first passed one
+
+    bool bAnd = (s.type == stepAnd);
+
+    QVector<double> rank(m_steps.size());
+    for (int nChild : s.children) {
+        double nDecisive = bAnd ? (1. - passRate(nChild)) : passRate(nChild);
+        rank[nChild] = m_steps.at(nChild).cost / nDecisive;
+    }
+
+    std::stable_sort(s.children.begin(), s.children.end(), [&rank](int a, int b) {
+        return rank[a] < rank[b];
+    });
+
+    double nCost  = 0.;
+    double nReach = 1.;
+    for (int nChild : s.children) {
+        nCost  += nReach * m_steps.at(nChild).cost;
+        nReach *= bAnd ? passRate(nChild) : (1. - passRate(nChild));
+    }
+    s.cost = nCost;
+}
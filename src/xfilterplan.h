@@ -0,0 +1,96 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#ifndef _xFilterPlan_h_
+#define _xFilterPlan_h_  1
+
+#include <QVector>
+
+#include "xdocument.h"
+#include "xbytematcher.h"
+
+class QTextCodec;
+class xFilterExpression;
+
+// filter rules and expressions compiled into tree of steps evaluated per
+// raw line with short circuit; children of AND run in order of cost per
+// chance to fail, children of OR in order of cost per chance to pass,
+// chances are counted while scanning and order is revised periodically,
+// so selective and cheap steps move to front; empty plan passes all lines
+
+class xFilterPlan {
+public:
+
+    xFilterPlan();
+    xFilterPlan(const filterRules & rules, QTextCodec * pCodec);
+    xFilterPlan(const searchRequestItem & item, QTextCodec * pCodec);
+    ~xFilterPlan();
+
+    bool        isEmpty() const {
+        return m_root == -1;
+    }
+
+    bool        matches(const char * pRaw, int length, QString & text);
+
+protected:
+
+    enum stepType {
+        stepPattern = 0,
+        stepRegExp  = 1,
+        stepAnd     = 2,
+        stepOr      = 3,
+        stepNot     = 4
+    };
+
+    struct step {
+        stepType            type        = stepPattern;
+        searchRequestItem   request;
+        searchRequestItem   prefilter;
+        xByteMatcher        byteMatcher;
+        QVector<int>        children;
+        double              cost        = 1.;
+        quint64             evaluated   = 0;
+        quint64             passed      = 0;
+    };
+
+    int         addItem(const searchRequestItem & item);
+    int         addExpression(const xFilterExpression & expression, int nNode);
+    int         addGroup(stepType type, const QVector<int> & children);
+
+    bool        evaluate(int nStep, const char * pRaw, int length, QString & text);
+    double      passRate(int nStep) const;
+    void        reorder(int nStep);
+
+    static  const   int     m_reorderInterval   = 4096;
+
+    // relative cost of leaf, text steps include decoding of line
+
+    static  constexpr double    m_byteCost      = 1.;
+    static  constexpr double    m_textCost      = 4.;
+    static  constexpr double    m_regexpCost    = 16.;
+
+    QTextCodec      *   m_pCodec    = nullptr;
+    QVector<step>       m_steps;
+    int                 m_root      = -1;
+    quint64             m_nLines    = 0;
+};
+
+#endif
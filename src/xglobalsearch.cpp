@@ -0,0 +1,261 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QTextCodec>
+
+#include "xglobalsearch.h"
+#include "xlog.h"
+
+xGlobalSearch::xGlobalSearch(QObject * pParent):
+    QObject(pParent) {
+    m_resultsModel = new xValueCollection<globalSearchResult>(this);
+
+    initModels();
+}
+
+xGlobalSearch::~xGlobalSearch() {
+    stop();
+}
+
+void    xGlobalSearch::search(const QVector<xDocument*> & documents, const QVector<QByteArray> & encodings, const searchRequestItem & item) {
+    stop();
+
+    m_resultsModel->clear();
+    m_encodings.clear();
+    m_nResults  = 0;
+    m_nSkipped  = 0;
+    m_bStarting = true;
+
+    for (int i = 0; i < documents.size(); i++) {
+        xDocument * pDocument = documents[i];
+
+        if (m_nResults >= m_maxResults)
+            break;
+
+        // each document searches in own worker, so requests below run in parallel,
+        // document without open file is skipped and reported in results
+
+        QString fileName = pDocument->fileName();
+
+        m_encodings[pDocument] = encodings.value(i);
+        m_pending << pDocument;
+
+        connect(pDocument, &xDocument::globalSearchResultsReady, this, [this, pDocument](const searchResults & results, bool bCompleted) {
+            onSearchResultsReady(pDocument, results, bCompleted);
+        });
+        connect(pDocument, &QObject::destroyed, this, [this, fileName]() {
+            onDocumentDestroyed(fileName);
+        });
+
+        if (!pDocument->startGlobalSearch(item, encodings.value(i), m_maxResults)) {
+            detach(pDocument);
+            appendNote(pDocument, fileName, tr("Skipped, file is not available"));
+            m_nSkipped++;
+        }
+    }
+
+    m_bStarting = false;
+
+    qCDebug(logicDocument) << "xGlobalSearch: searching in " << m_pending.size() << " documents, skipped " << m_nSkipped;
+
+    if (m_nResults >= m_maxResults)
+        return;
+
+    if (m_pending.isEmpty()) {
+        if (m_nSkipped == documents.size()) {
+            finish(tr("Unable to search, files are not available"));
+        }
+        else {
+            finish(tr("Search in files completed, %1 results found").arg(m_nResults));
+        }
+        return;
+    }
+
+    emit message(tr("Searching in %1 files...").arg(m_pending.size()));
+}
+
+void    xGlobalSearch::cancel() {
+    if (!isRunning())
+        return;
+
+    stop();
+    finish(tr("Search in files cancelled, %1 results found").arg(m_nResults));
+}
+
+void    xGlobalSearch::clear() {
+    cancel();
+    m_resultsModel->clear();
+    m_nResults = 0;
+}
+
+bool    xGlobalSearch::isRunning() const {
+    return !m_pending.isEmpty();
+}
+
+void    xGlobalSearch::setMaxResults(int nMaxResults) {
+    m_maxResults = qMax(1, nMaxResults);
+}
+
+int     xGlobalSearch::maxResults() const {
+    return m_maxResults;
+}
+
+QAbstractTableModel *   xGlobalSearch::results() const {
+    return m_resultsModel;
+}
+
+globalSearchResult      xGlobalSearch::resultAt(int row) const {
+    return m_resultsModel->itemAt(row);
+}
+
+void    xGlobalSearch::stop() {
+    const QList< QPointer<xDocument> > pending = m_pending;
+
+    for (const QPointer<xDocument> & pDocument : pending) {
+        if (!pDocument)
+            continue;
+
+        detach(pDocument);
+        pDocument->cancelGlobalSearch();
+    }
+
+    m_pending.clear();
+}
+
+void    xGlobalSearch::detach(xDocument * pDocument) {
+    disconnect(pDocument, nullptr, this, nullptr);
+    m_pending.removeAll(pDocument);
+}
+
+void    xGlobalSearch::appendNote(xDocument * pDocument, const QString & fileName, const QString & note) {
+    searchResult    result;
+    result.lineNumber = -1;
+
+    m_resultsModel->appendItem(globalSearchResult{ pDocument, fileName, result, note });
+}
+
+void    xGlobalSearch::onSearchResultsReady(xDocument * pDocument, const searchResults & results, bool bCompleted) {
+    int nRoom = m_maxResults - m_nResults;
+
+    QVector<globalSearchResult> items;
+    items.reserve(qMin(nRoom, results.size()));
+
+    for (const searchResult & result : results) {
+        if (items.size() >= nRoom)
+            break;
+
+        items << globalSearchResult{ pDocument, pDocument->fileName(), result, QString() };
+    }
+
+    if (!items.isEmpty()) {
+        m_resultsModel->appendItems(items);
+        m_nResults += items.size();
+    }
+
+    // common cap reached, remaining documents are interrupted
+
+    if (m_nResults >= m_maxResults) {
+        stop();
+        finish(tr("Search in files stopped, limit of %1 results reached").arg(m_maxResults));
+        return;
+    }
+
+    if (bCompleted) {
+        detach(pDocument);
+        checkFinished();
+    }
+}
+
+// document closed while being searched counts as finished, its pointer
+// is already cleared in pending list at this moment
+
+void    xGlobalSearch::onDocumentDestroyed(const QString & fileName) {
+    m_pending.removeAll(QPointer<xDocument>());
+
+    appendNote(nullptr, fileName, tr("Closed before search completed"));
+    checkFinished();
+}
+
+void    xGlobalSearch::checkFinished() {
+    if (m_pending.isEmpty() && !m_bStarting) {
+        finish(tr("Search in files completed, %1 results found").arg(m_nResults));
+    }
+}
+
+void    xGlobalSearch::finish(const QString & text) {
+    emit message(text, 3000);
+    emit finished();
+}
+
+void    xGlobalSearch::initModels() {
+    m_resultsModel->setColumnCount(3);
+    m_resultsModel->setDataCallback([this](int row, int column, int /* role */) -> QVariant {
+        const globalSearchResult & item = m_resultsModel->itemAt(row);
+        switch (column) {
+        case globalResultColumnFile:
+            return item.fileName;
+        case globalResultColumnLineNumber:
+            if (item.result.lineNumber < 0)
+                return QVariant();
+
+            return item.result.lineNumber + 1;
+        case globalResultColumnText: {
+            if (!item.note.isEmpty())
+                return item.note;
+
+            if (!item.document)
+                return QVariant();
+
+            QTextCodec * pCodec = QTextCodec::codecForName(m_encodings.value(item.document));
+            if (!pCodec) {
+                pCodec = QTextCodec::codecForLocale();
+            }
+            return pCodec->toUnicode(item.document->sourceLine(item.result.lineNumber)).trimmed();
+        }
+        }
+        return QVariant();
+    }, Qt::DisplayRole);
+
+    m_resultsModel->setHeaderCallback([this](int section, Qt::Orientation orientation, int /*role = Qt::DisplayRole*/) -> QVariant {
+        if (orientation != Qt::Horizontal)
+            return QVariant();
+
+        switch (section) {
+        case globalResultColumnFile:
+            return QString(tr("File"));
+        case globalResultColumnLineNumber:
+            return QString(tr("Line"));
+        case globalResultColumnText:
+            return QString(tr("Text"));
+        }
+
+        return QVariant();
+    }, Qt::DisplayRole);
+
+    m_resultsModel->setFlagsCallback([this](int row, int /*column*/, Qt::ItemFlags defaultFlags) -> Qt::ItemFlags {
+        const globalSearchResult & item = m_resultsModel->itemAt(row);
+        if (!item.document || (item.result.lineNumber < 0) || (item.document->sourceToLogicalLineNumber(item.result.lineNumber) == -1)) {
+            return (defaultFlags & ~(Qt::ItemIsEnabled));
+        }
+
+        return defaultFlags;
+    });
+}
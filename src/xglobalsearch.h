@@ -0,0 +1,99 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xGlobalSearch_h_
+#define _xGlobalSearch_h_  1
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+
+#include "xvaluelistmodel.h"
+#include "xdocument.h"
+
+enum {
+    globalResultColumnFile       = 0,
+    globalResultColumnLineNumber = 1,
+    globalResultColumnText       = 2
+};
+
+// row without line number is a note about document which was not
+// searched completely, text tells why
+
+struct globalSearchResult {
+    QPointer<xDocument>     document;
+    QString                 fileName;
+    searchResult            result;
+    QString                 note;
+};
+
+// runs same request on several documents at once, every document searches
+// in its own processor thread apart from its find results, results are
+// merged into one model in order of arrival and limited by common cap
+
+class xGlobalSearch : public QObject {
+    Q_OBJECT
+public:
+
+    xGlobalSearch(QObject * pParent = nullptr);
+    ~xGlobalSearch();
+
+    void                    search(const QVector<xDocument*> & documents, const QVector<QByteArray> & encodings, const searchRequestItem & item);
+    void                    cancel();
+    void                    clear();
+    bool                    isRunning() const;
+
+    void                    setMaxResults(int nMaxResults);
+    int                     maxResults() const;
+
+    QAbstractTableModel *   results() const;
+    globalSearchResult      resultAt(int row) const;
+
+signals:
+
+    void        message(const QString & message, int timeout = 0);
+    void        finished();
+
+protected:
+
+    void        initModels();
+    void        stop();
+    void        detach(xDocument * pDocument);
+    void        appendNote(xDocument * pDocument, const QString & fileName, const QString & note);
+    void        onSearchResultsReady(xDocument * pDocument, const searchResults & results, bool bCompleted);
+    void        onDocumentDestroyed(const QString & fileName);
+    void        checkFinished();
+    void        finish(const QString & message);
+
+protected:
+
+    int                                     m_maxResults    = 100000;
+
+    xValueCollection<globalSearchResult> *  m_resultsModel  = nullptr;
+    QMap<xDocument*, QByteArray>            m_encodings;
+    QList< QPointer<xDocument> >            m_pending;
+    int                                     m_nResults      = 0;
+    int                                     m_nSkipped      = 0;
+    bool                                    m_bStarting     = false;
+};
+
+#endif
@@ -22,12 +22,13 @@
 #include <QTextLayout>
 
 #include "xhighlighter.h"
+#include "xregexpprefilter.h"
 
 xHighlighter::xHighlighter(QObject * pParent):
     QObject(pParent) {
 
     m_highlighters = new xValueCollection<highlighterItem>(this);
-    m_highlighters->setColumntCount(3);
+    m_highlighters->setColumnCount(3);
     m_highlighters->setDataCallback([this](int row, int column, int /* role */) -> QVariant {
         const highlighterItem & item = m_highlighters->itemAt(row);      
             switch (column) {            
@@ -108,6 +109,8 @@ xHighlighter::xHighlighter(QObject * pParent):
 
         return QVariant();
     }, Qt::DisplayRole);    
+
+    connect(this, &xHighlighter::highlightRulesChanged, this, &xHighlighter::rebuildMatchers);
 }
 
 xHighlighter::~xHighlighter() {
@@ -117,17 +120,70 @@ xHighlighter::~xHighlighter() {
 QVector<QTextLayout::FormatRange>  xHighlighter::highlight(const QString & str) const {
     QVector<QTextLayout::FormatRange> result;
 
-    QVectorIterator<highlighterItem>      it(m_highlighters->items());
-    while (it.hasNext()) {
-        const highlighterItem & item = it.next();
-        if (item.isActive) {
+    // all active pattern highlighters are found in one pass, hits are then
+    // placed in rules order, so overlapping rules are painted as before
+
+    QVector< QVector<QTextLayout::FormatRange> >    patternRanges(m_patternMatcher.patternCount());
+
+    if (!m_patternMatcher.isEmpty()) {
+        QVector<int>    nextStart(m_patternMatcher.patternCount(), 0);
+
+        for (const xMultiMatcher::match & m : m_patternMatcher.findAll(str)) {
+            if (m.start < nextStart[m.pattern])
+                continue;
+
+            QTextLayout::FormatRange range;
+            range.format = m_highlighters->itemAt(m_patternItems[m.pattern]).format;
+            range.start  = m.start;
+            range.length = m.length;
+
+            patternRanges[m.pattern] << range;
+            nextStart[m.pattern] = m.start + m.length;
+        }
+    }
+
+    int nPattern = 0;
+    for (int nItem = 0; nItem < m_highlighters->items().size(); nItem++) {
+        const highlighterItem & item = m_highlighters->items().at(nItem);
+        if (!item.isActive)
+            continue;
+
+        if ((nPattern < m_patternItems.size()) && (m_patternItems[nPattern] == nItem)) {
+            result << patternRanges[nPattern++];
+        }
+        else if ((item.type == RegExtHighlighter) && (nItem < m_regexpPrefilters.size()) && !m_regexpPrefilters[nItem].pattern().isEmpty() && (m_regexpPrefilters[nItem].indexIn(str) == -1)) {
+            continue;
+        }
+        else {
             result << highlight(str, item);
-        }        
+        }
     }
 
     return result;
 }
 
+void xHighlighter::rebuildMatchers() {
+    m_patternMatcher.clear();
+    m_patternItems.clear();
+    m_regexpPrefilters.fill(QStringMatcher(), m_highlighters->items().size());
+
+    for (int nItem = 0; nItem < m_highlighters->items().size(); nItem++) {
+        const highlighterItem & item = m_highlighters->items().at(nItem);
+        if (!item.isActive)
+            continue;
+
+        if ((item.type == PatternHighlighter) && !item.matcher.pattern().isEmpty()) {
+            m_patternMatcher.addPattern(item.matcher.pattern(), item.matcher.caseSensitivity());
+            m_patternItems << nItem;
+        }
+        else if (item.type == RegExtHighlighter) {
+            m_regexpPrefilters[nItem] = xRegExpPrefilter::prefilterItem(item.regexp).matcher;
+        }
+    }
+
+    m_patternMatcher.build();
+}
+
 void xHighlighter::appendHighlight(const highlighterItem & item) {
     if (std::find(m_highlighters->items().begin(), m_highlighters->items().end(), item) == m_highlighters->items().end()) {
         m_highlighters->appendItem(item);
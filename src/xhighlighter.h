@@ -29,6 +29,7 @@
 #include <QRegularExpression>
 
 #include "xvaluelistmodel.h"
+#include "xmultimatcher.h"
 
 enum {
     highlighterViewColumnVisible = 0,
@@ -113,8 +114,16 @@ signals:
 
     void       highlightRulesChanged();
 
+protected:
+
+    void       rebuildMatchers();
+
 protected:
 
     xValueCollection<highlighterItem> *  m_highlighters = nullptr;
+
+    xMultiMatcher                        m_patternMatcher;
+    QVector<int>                         m_patternItems;
+    QVector<QStringMatcher>              m_regexpPrefilters;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+#include "xindexcache.h"
+#include "xlineindex.h"
+#include "xsysteminformation.h"
+#include "xlog.h"
+
+static  const   quint32     cacheMagic          = 0x514C5649;
+static  const   quint32     cacheVersion        = 4;
+static  const   quint64     cacheHashedLength   = 64 * 1024;
+static  const   qint64      cacheBudget         = 512 * 1024 * 1024;
+static  const   int         cacheMaxFiles       = 256;
+
+// stream format is pinned so cache files stay readable across Qt versions,
+// byte order is QDataStream default (big endian) on every platform
+
+static  const   QDataStream::Version    cacheStreamVersion  = QDataStream::Qt_5_6;
+
+QString     xIndexCache::cacheDirectory() {
+    QString location = xSystemInformation::appDataLocation();
+    if (location.isEmpty())
+        return QString();
+
+    QDir    d(location);
+    if (!d.exists("index") && !d.mkpath("index"))
+        return QString();
+
+    return d.absoluteFilePath("index");
+}
+
+QString     xIndexCache::cacheFileName(const QString & filePath) {
+    QString location = cacheDirectory();
+    if (location.isEmpty())
+        return QString();
+
+    QByteArray  key = QCryptographicHash::hash(QFileInfo(filePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return QDir(location).absoluteFilePath(QString("%1.idx").arg(QString::fromLatin1(key)));
+}
+
+QByteArray  xIndexCache::contentHash(QFile & f, quint64 from, quint64 length) {
+    if (!f.seek(from))
+        return QByteArray();
+
+    return QCryptographicHash::hash(f.read(length), QCryptographicHash::Md5);
+}
+
+xIndexCache::cacheState  xIndexCache::load(const QString & filePath, xLineIndex * pIndex) {
+    QString     cachePath = cacheFileName(filePath);
+    if (cachePath.isEmpty())
+        return cacheMissing;
+
+    QFile       cacheFile(cachePath);
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return cacheMissing;
+
+    QDataStream stream(&cacheFile);
+    stream.setVersion(cacheStreamVersion);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    quint32     magic   = 0;
+    quint32     version = 0;
+    QString     indexedPath;
+    quint64     indexedSize = 0;
+    qint64      indexedTime = 0;
+    quint64     headLength  = 0;
+    quint64     tailLength  = 0;
+    QByteArray  headHash;
+    QByteArray  tailHash;
+
+    stream >> magic >> version;
+
+    if ((stream.status() != QDataStream::Ok) || (magic != cacheMagic) || (version != cacheVersion))
+        return cacheMissing;
+
+    stream >> indexedPath >> indexedSize >> indexedTime >> headLength >> headHash >> tailLength >> tailHash;
+
+    if (stream.status() != QDataStream::Ok)
+        return cacheMissing;
+
+    QFileInfo   fi(filePath);
+    if (fi.absoluteFilePath() != indexedPath)
+        return cacheMissing;
+
+    quint64     currentSize = fi.size();
+    cacheState  state       = cacheMissing;
+
+    if ((currentSize == indexedSize) && (fi.lastModified().toMSecsSinceEpoch() == indexedTime)) {
+        state = cacheValid;
+    }
+    else if (currentSize > indexedSize) {
+        state = cacheAppended;
+    }
+    else {
+        qCDebug(logicDocument) << "xIndexCache: cached index for " << filePath << " is outdated";
+        return cacheMissing;
+    }
+
+    QFile   f(filePath);
+    if (!f.open(QIODevice::ReadOnly))
+        return cacheMissing;
+
+    if ((contentHash(f, 0, headLength) != headHash) || (contentHash(f, indexedSize - tailLength, tailLength) != tailHash)) {
+        qCDebug(logicDocument) << "xIndexCache: content of " << filePath << " changed since it was indexed";
+        return cacheMissing;
+    }
+
+    if (!pIndex->read(stream))
+        return cacheMissing;
+
+    // modification time of cache file is used as last access time for eviction
+    cacheFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    qCDebug(logicDocument) << "xIndexCache: loaded " << pIndex->size() << " lines for " << filePath << (state == cacheAppended ? ", file has grown" : "");
+
+    return state;
+}
+
+bool    xIndexCache::save(const QString & filePath, const xLineIndex & index) {
+    QString     cachePath = cacheFileName(filePath);
+    if (cachePath.isEmpty() || index.isEmpty())
+        return false;
+
+    QFile       f(filePath);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QFileInfo   fi(filePath);
+    quint64     indexedSize = index.lastPosition() + index.lastLength();
+    quint64     headLength  = qMin(indexedSize, cacheHashedLength);
+    quint64     tailLength  = qMin(indexedSize, cacheHashedLength);
+
+    QSaveFile   cacheFile(cachePath);
+    if (!cacheFile.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&cacheFile);
+    stream.setVersion(cacheStreamVersion);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    stream << cacheMagic << cacheVersion << fi.absoluteFilePath() << indexedSize << fi.lastModified().toMSecsSinceEpoch()
+           << headLength << contentHash(f, 0, headLength)
+           << tailLength << contentHash(f, indexedSize - tailLength, tailLength);
+
+    if (!index.write(stream)) {
+        cacheFile.cancelWriting();
+        return false;
+    }
+
+    if (!cacheFile.commit())
+        return false;
+
+    evict(cachePath);
+
+    return true;
+}
+
+void    xIndexCache::evict(const QString & keepPath) {
+    QString location = cacheDirectory();
+    if (location.isEmpty())
+        return;
+
+    // least recently used files go first, until total size and count fit the budget
+
+    QFileInfoList   files = QDir(location).entryInfoList(QStringList() << "*.idx", QDir::Files, QDir::Time);
+    qint64          nTotal = 0;
+    int             nKept  = 0;
+
+    for (const QFileInfo & fi : files) {
+        if (fi.absoluteFilePath() == QFileInfo(keepPath).absoluteFilePath()) {
+            nTotal += fi.size();
+            nKept++;
+            continue;
+        }
+
+        if ((nKept < cacheMaxFiles - 1) && (nTotal + fi.size() <= cacheBudget)) {
+            nTotal += fi.size();
+            nKept++;
+            continue;
+        }
+
+        qCDebug(logicDocument) << "xIndexCache: evicting " << fi.fileName();
+        QFile::remove(fi.absoluteFilePath());
+    }
+}
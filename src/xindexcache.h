@@ -0,0 +1,52 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xIndexCache_h_
+#define _xIndexCache_h_  1
+
+#include <QString>
+#include <QByteArray>
+
+class QFile;
+class xLineIndex;
+
+class xIndexCache {
+public:
+
+    enum cacheState {
+        cacheMissing    = 0,
+        cacheValid      = 1,
+        cacheAppended   = 2
+    };
+
+    static  cacheState      load(const QString & filePath, xLineIndex * pIndex);
+    static  bool            save(const QString & filePath, const xLineIndex & index);
+
+protected:
+
+    static  QString         cacheDirectory();
+    static  QString         cacheFileName(const QString & filePath);
+    static  void            evict(const QString & keepPath);
+    static  QByteArray      contentHash(QFile & f, quint64 from, quint64 length);
+};
+
+#endif
@@ -26,10 +26,12 @@
 #include <QMenu>
 #include <QColorDialog>
 #include <QHeaderView>
+#include <QLabel>
 
 #include "xinfopanel.h"
 #include "xplaintextviewer.h"
 #include "xtreeview.h"
+#include "xsearchresultsmodel.h"
 
 
 xInfoPanel::xInfoPanel(QWidget * pParent):
@@ -63,6 +65,14 @@ xInfoPanel::xInfoPanel(QWidget * pParent):
     connect(m_findResults, &QTreeView::clicked, this, &xInfoPanel::findResultItemClicked);
     connect(m_findResults, &QTreeView::customContextMenuRequested, this, &xInfoPanel::findResultsContextMenuRequested);
 
+    m_globalFindResults = new xTreeView();
+    m_globalFindResults->setFrameShape(QFrame::NoFrame);
+    m_globalFindResults->setPlaceholderText(tr("No search results in files"));
+    m_globalFindResults->setPlaceholderFont(placeholderFont);
+    m_globalFindResults->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_globalFindResults, &QTreeView::clicked, this, &xInfoPanel::globalFindResultItemClicked);
+    connect(m_globalFindResults, &QTreeView::customContextMenuRequested, this, &xInfoPanel::globalFindResultsContextMenuRequested);
+
     m_filters = new xTreeView();
     m_filters->setFrameShape(QFrame::NoFrame);
     m_filters->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -82,9 +92,14 @@ xInfoPanel::xInfoPanel(QWidget * pParent):
 
     m_tabs->addTab(m_bookmarks, tr("Bookmarks"));
     m_tabs->addTab(m_findResults, tr("Find results"));
+    m_tabs->addTab(m_globalFindResults, tr("Find in files"));
     m_tabs->addTab(m_filters, tr("Filters"));
     m_tabs->addTab(m_highlighters, tr("Highlights"));
 
+    m_resultCache = new QLabel();
+    m_resultCache->setContentsMargins(4, 0, 4, 0);
+    m_tabs->setCornerWidget(m_resultCache, Qt::BottomRightCorner);
+
     setMinimumHeight(50);
     setLayout(pLayout);
 }
@@ -92,13 +107,24 @@ xInfoPanel::xInfoPanel(QWidget * pParent):
 xInfoPanel::~xInfoPanel() {
 }
 
+void    xInfoPanel::setResultCacheStatistics(int nHits, int nMisses, qint64 nBudget) {
+    m_resultCache->setText(tr("Result cache: %1 hits, %2 misses, %3 MB").arg(nHits).arg(nMisses).arg(nBudget / (1024 * 1024)));
+}
+
 void    xInfoPanel::findResultItemClicked(const QModelIndex & index) {
-    xValueCollection<searchResult>   * pResults = dynamic_cast<xValueCollection<searchResult>*>(m_findResults->model());
+    xSearchResultsModel   * pResults = dynamic_cast<xSearchResultsModel*>(m_findResults->model());
     if (pResults) {
         emit ensureSearchResultVisible(pResults->itemAt(index.row()));
     }
 }
 
+void    xInfoPanel::globalFindResultItemClicked(const QModelIndex & index) {
+    xValueCollection<globalSearchResult>   * pResults = dynamic_cast<xValueCollection<globalSearchResult>*>(m_globalFindResults->model());
+    if (pResults) {
+        emit ensureGlobalSearchResultVisible(pResults->itemAt(index.row()));
+    }
+}
+
 void    xInfoPanel::bookmarksItemClicked(const QModelIndex & index) {
     xValueCollection<documentBookmark>   * pResults = dynamic_cast<xValueCollection<documentBookmark>*>(m_bookmarks->model());
     if (pResults) {
@@ -136,14 +162,33 @@ void    xInfoPanel::findResultsContextMenuRequested(const QPoint & pos) {
     QMenu contextMenu(this);
     QAction clearAction (tr("Clear"), &contextMenu);
     connect(&clearAction, &QAction::triggered, [this]() {
-        xValueCollection<searchResult>   * pModel = dynamic_cast<xValueCollection<searchResult>*>(m_findResults->model());
-        pModel->clear();
+        xSearchResultsModel   * pModel = dynamic_cast<xSearchResultsModel*>(m_findResults->model());
+        if (pModel) {
+            pModel->clear();
+        }
     });
 
     contextMenu.addAction(&clearAction);
     contextMenu.exec(m_findResults->mapToGlobal(pos));
 }
 
+void    xInfoPanel::globalFindResultsContextMenuRequested(const QPoint & pos) {
+    QMenu contextMenu(this);
+    QAction stopAction (tr("Stop"), &contextMenu);
+    connect(&stopAction, &QAction::triggered, [this]() {
+        emit cancelGlobalSearchRequest();
+    });
+
+    QAction clearAction (tr("Clear"), &contextMenu);
+    connect(&clearAction, &QAction::triggered, [this]() {
+        emit clearGlobalSearchRequest();
+    });
+
+    contextMenu.addAction(&stopAction);
+    contextMenu.addAction(&clearAction);
+    contextMenu.exec(m_globalFindResults->mapToGlobal(pos));
+}
+
 void    xInfoPanel::bookmarksItemContextMenuRequested(const QPoint &pos) {
     if (m_bookmarks->currentIndex().isValid()) {
         xValueCollection<documentBookmark>   * pBookmarks = dynamic_cast<xValueCollection<documentBookmark>*>(m_bookmarks->model());
@@ -245,6 +290,10 @@ void    xInfoPanel::activateFindResults() {
     m_tabs->setCurrentWidget(m_findResults);
 }
 
+void    xInfoPanel::activateGlobalFindResults() {
+    m_tabs->setCurrentWidget(m_globalFindResults);
+}
+
 void    xInfoPanel::filtersItemClicked(const QModelIndex & index) {
     xValueCollection<filterRule>   * pFilter = dynamic_cast<xValueCollection<filterRule>*>(m_filters->model());
     if (pFilter) {
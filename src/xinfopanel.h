@@ -30,9 +30,11 @@
 #include "xdocument.h"
 #include "xhighlighter.h"
 #include "xplaintextviewer.h"
+#include "xglobalsearch.h"
 
 class QTabWidget;
 class QTreeView;
+class QLabel;
 
 class 	xInfoPanel: public QWidget {
 	Q_OBJECT
@@ -42,6 +44,7 @@ public:
 
     QTreeView   *   bookmarks() const       { return m_bookmarks; };
     QTreeView   *   findResults() const     { return m_findResults; };
+    QTreeView   *   globalFindResults() const { return m_globalFindResults; };
     QTreeView   *   filters() const         { return m_filters; };
     QTreeView   *   highlighters() const    { return m_highlighters; };
 
@@ -51,6 +54,9 @@ public slots:
     void    activateBookmarks();
     void    activateFilters();
     void    activateFindResults();
+    void    activateGlobalFindResults();
+
+    void    setResultCacheStatistics(int nHits, int nMisses, qint64 nBudget);
 
     void    highlighterItemClicked(const QModelIndex & index);
     void    highlighterItemContextMenuRequested(const QPoint &pos);
@@ -58,6 +64,9 @@ public slots:
     void    findResultItemClicked(const QModelIndex & index);
     void    findResultsContextMenuRequested(const QPoint &pos);
 
+    void    globalFindResultItemClicked(const QModelIndex & index);
+    void    globalFindResultsContextMenuRequested(const QPoint &pos);
+
     void    bookmarksItemClicked(const QModelIndex & index);
     void    bookmarksItemContextMenuRequested(const QPoint &pos);
     
@@ -78,15 +87,20 @@ signals:
     void    deleteAllFiltersRequest();
 
     void    ensureSearchResultVisible(const searchResult &);
+    void    ensureGlobalSearchResultVisible(const globalSearchResult &);
+    void    cancelGlobalSearchRequest();
+    void    clearGlobalSearchRequest();
     void    ensureBookmarkVisible(const documentBookmark &);
 
 protected:
 
     QTabWidget       *   m_tabs         = nullptr;
+    QLabel           *   m_resultCache  = nullptr;
 
     xTreeView       *   m_bookmarks     = nullptr;
     xTreeView       *   m_filters       = nullptr;
     xTreeView       *   m_findResults   = nullptr;
+    xTreeView       *   m_globalFindResults = nullptr;
     xTreeView       *   m_highlighters  = nullptr;
 };
 
@@ -0,0 +1,251 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <algorithm>
+
+#include "xlinebitmap.h"
+
+xLineBitmap::xLineBitmap() {
+}
+
+xLineBitmap::~xLineBitmap() {
+}
+
+void    xLineBitmap::clear() {
+    m_chunks.clear();
+    m_count = 0;
+    m_last  = -1;
+}
+
+void    xLineBitmap::append(qint64 line) {
+    if ((line < 0) || (line <= m_last))
+        return;
+
+    qint64  nKey = line >> m_chunkShift;
+    quint16 nLow = line & m_chunkMask;
+
+    if (m_chunks.isEmpty() || (m_chunks.last().key != nKey)) {
+        chunk c;
+        c.key = nKey;
+        m_chunks << c;
+    }
+
+    chunk & c = m_chunks.last();
+    if (c.bits.isEmpty()) {
+        c.values << nLow;
+        if (c.values.size() > m_sparseLimit)
+            toDense(c);
+    } else {
+        c.bits[nLow >> 6] |= (quint64)1 << (nLow & 63);
+    }
+
+    c.count++;
+    m_count++;
+    m_last = line;
+}
+
+void    xLineBitmap::truncate(qint64 line) {
+    if (line > m_last)
+        return;
+
+    qint64  nKey = line >> m_chunkShift;
+    quint16 nLow = line & m_chunkMask;
+
+    while (!m_chunks.isEmpty() && (m_chunks.last().key > nKey)) {
+        m_count -= m_chunks.last().count;
+        m_chunks.removeLast();
+    }
+
+    if (!m_chunks.isEmpty() && (m_chunks.last().key == nKey)) {
+        chunk & c = m_chunks.last();
+        m_count -= c.count;
+
+        if (c.bits.isEmpty()) {
+            c.values.resize(std::lower_bound(c.values.begin(), c.values.end(), nLow) - c.values.begin());
+            c.count = c.values.size();
+        } else {
+            int nWord = nLow >> 6;
+            c.bits[nWord] &= ((quint64)1 << (nLow & 63)) - 1;
+            std::fill(c.bits.begin() + nWord + 1, c.bits.end(), 0);
+
+            c.count = 0;
+            for (quint64 w : c.bits)
+                c.count += qPopulationCount(w);
+
+            if (c.count <= m_sparseLimit)
+                toSparse(c);
+        }
+
+        m_count += c.count;
+        if (!c.count)
+            m_chunks.removeLast();
+    }
+
+    updateLast();
+}
+
+bool    xLineBitmap::contains(qint64 line) const {
+    if ((line < 0) || (line > m_last))
+        return false;
+
+    int nIndex = findChunk(line >> m_chunkShift);
+    if (nIndex == -1)
+        return false;
+
+    const chunk & c = m_chunks.at(nIndex);
+    quint16 nLow = line & m_chunkMask;
+
+    if (c.bits.isEmpty())
+        return std::binary_search(c.values.begin(), c.values.end(), nLow);
+
+    return c.bits.at(nLow >> 6) & ((quint64)1 << (nLow & 63));
+}
+
+void    xLineBitmap::intersect(const xLineBitmap & other) {
+    QVector<chunk>  result;
+    qint64          nCount = 0;
+
+    int i = 0;
+    int j = 0;
+    while ((i < m_chunks.size()) && (j < other.m_chunks.size())) {
+        const chunk & a = m_chunks.at(i);
+        const chunk & b = other.m_chunks.at(j);
+
+        if (a.key < b.key) {
+            i++;
+        } else if (b.key < a.key) {
+            j++;
+        } else {
+            chunk c = intersectChunks(a, b);
+            if (c.count) {
+                nCount += c.count;
+                result << c;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    m_chunks = result;
+    m_count  = nCount;
+    updateLast();
+}
+
+quint64 xLineBitmap::memoryUsage() const {
+    quint64 nSize = m_chunks.capacity() * sizeof(chunk);
+    for (const chunk & c : m_chunks)
+        nSize += c.values.capacity() * sizeof(quint16) + c.bits.capacity() * sizeof(quint64);
+
+    return nSize;
+}
+
+int     xLineBitmap::findChunk(qint64 key) const {
+    auto it = std::lower_bound(m_chunks.begin(), m_chunks.end(), key, [](const chunk & c, qint64 key) {
+        return c.key < key;
+    });
+
+    if ((it == m_chunks.end()) || (it->key != key))
+        return -1;
+
+    return it - m_chunks.begin();
+}
+
+void    xLineBitmap::updateLast() {
+    if (m_chunks.isEmpty()) {
+        m_last = -1;
+        return;
+    }
+
+    const chunk & c = m_chunks.last();
+    qint64 nBase = c.key << m_chunkShift;
+
+    if (c.bits.isEmpty()) {
+        m_last = nBase + c.values.last();
+        return;
+    }
+
+    for (int i = m_chunkWords - 1; i >= 0; i--) {
+        quint64 nWord = c.bits.at(i);
+        if (nWord) {
+            m_last = nBase + (i << 6) + 63 - qCountLeadingZeroBits(nWord);
+            return;
+        }
+    }
+}
+
+void    xLineBitmap::toDense(chunk & c) {
+    c.bits.fill(0, m_chunkWords);
+    for (quint16 v : c.values)
+        c.bits[v >> 6] |= (quint64)1 << (v & 63);
+
+    c.values = QVector<quint16>();
+}
+
+void    xLineBitmap::toSparse(chunk & c) {
+    QVector<quint16> values;
+    values.reserve(c.count);
+
+    for (int i = 0; i < m_chunkWords; i++) {
+        quint64 nWord = c.bits.at(i);
+        while (nWord) {
+            values << quint16((i << 6) + qCountTrailingZeroBits(nWord));
+            nWord &= nWord - 1;
+        }
+    }
+
+    c.values = values;
+    c.bits   = QVector<quint64>();
+}
+
+xLineBitmap::chunk xLineBitmap::intersectChunks(const chunk & a, const chunk & b) {
+    chunk c;
+    c.key = a.key;
+
+    if (a.bits.isEmpty() && b.bits.isEmpty()) {
+        c.values.reserve(qMin(a.count, b.count));
+        std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(c.values));
+        c.count = c.values.size();
+        return c;
+    }
+
+    if (a.bits.isEmpty() || b.bits.isEmpty()) {
+        const chunk & sparse = a.bits.isEmpty() ? a : b;
+        const chunk & dense  = a.bits.isEmpty() ? b : a;
+
+        for (quint16 v : sparse.values) {
+            if (dense.bits.at(v >> 6) & ((quint64)1 << (v & 63)))
+                c.values << v;
+        }
+        c.count = c.values.size();
+        return c;
+    }
+
+    c.bits.resize(m_chunkWords);
+    for (int i = 0; i < m_chunkWords; i++) {
+        c.bits[i] = a.bits.at(i) & b.bits.at(i);
+        c.count  += qPopulationCount(c.bits.at(i));
+    }
+
+    if (c.count <= m_sparseLimit)
+        toSparse(c);
+
+    return c;
+}
@@ -0,0 +1,106 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#ifndef _xLineBitmap_h_
+#define _xLineBitmap_h_  1
+
+#include <QVector>
+#include <QtAlgorithms>
+
+// set of source line numbers compressed roaring style, lines are grouped by
+// upper bits into chunks of 65536, sparse chunk keeps sorted lower halves,
+// dense one keeps plain bitset, lines are appended in ascending order only
+
+class xLineBitmap {
+public:
+
+    xLineBitmap();
+    ~xLineBitmap();
+
+    qint64      count() const {
+        return m_count;
+    }
+
+    bool        isEmpty() const {
+        return m_count == 0;
+    }
+
+    qint64      last() const {
+        return m_last;
+    }
+
+    void        clear();
+    void        append(qint64 line);
+    void        truncate(qint64 line);
+    bool        contains(qint64 line) const;
+
+    void        intersect(const xLineBitmap & other);
+
+    template <typename Callback>
+    void        forEach(Callback callback) const {
+        for (const chunk & c : m_chunks) {
+            qint64 nBase = c.key << m_chunkShift;
+
+            if (c.bits.isEmpty()) {
+                for (quint16 v : c.values)
+                    callback(nBase + v);
+                continue;
+            }
+
+            for (int i = 0; i < m_chunkWords; i++) {
+                quint64 nWord = c.bits.at(i);
+                while (nWord) {
+                    callback(nBase + (i << 6) + qCountTrailingZeroBits(nWord));
+                    nWord &= nWord - 1;
+                }
+            }
+        }
+    }
+
+    quint64     memoryUsage() const;
+
+protected:
+
+    static  const   int     m_chunkShift    = 16;
+    static  const   int     m_chunkMask     = (1 << m_chunkShift) - 1;
+    static  const   int     m_chunkWords    = (1 << m_chunkShift) / 64;
+    static  const   int     m_sparseLimit   = 4096;
+
+    struct chunk {
+        qint64              key     = 0;
+        int                 count   = 0;
+        QVector<quint16>    values;
+        QVector<quint64>    bits;
+    };
+
+    int             findChunk(qint64 key) const;
+    void            updateLast();
+
+    static  void    toDense(chunk & c);
+    static  void    toSparse(chunk & c);
+    static  chunk   intersectChunks(const chunk & a, const chunk & b);
+
+    QVector<chunk>  m_chunks;
+    qint64          m_count = 0;
+    qint64          m_last  = -1;
+};
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "xlineindex.h"
+
+static inline quint64   decodeDelta(const quint8 *& pData) {
+    quint64     value = 0;
+    int         shift = 0;
+
+    while (*pData & 0x80) {
+        value |= (quint64)(*pData++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    return value | ((quint64)(*pData++) << shift);
+}
+
+xLineIndex::xLineIndex() {
+}
+
+xLineIndex::~xLineIndex() {
+}
+
+void    xLineIndex::clear() {
+    m_anchors.clear();
+    m_deltas.clear();
+    m_count        = 0;
+    m_lastPosition = 0;
+    m_lastLength   = 0;
+}
+
+void    xLineIndex::append(quint64 position, int length) {
+    if ((m_count & m_blockMask) == 0) {
+        if (m_deltas.remainingInSegment() < m_maxBlockDeltaSize) {
+            m_deltas.resize(m_deltas.size() + m_deltas.remainingInSegment());
+        }
+
+        blockAnchor anchor;
+        anchor.position = position;
+        anchor.offset   = m_deltas.size();
+        m_anchors << anchor;
+    }
+    else {
+        appendDelta(position - m_lastPosition);
+    }
+
+    m_lastPosition = position;
+    m_lastLength   = length;
+    m_count++;
+}
+
+void    xLineIndex::appendDelta(quint64 delta) {
+    while (delta >= 0x80) {
+        m_deltas << (quint8)(delta | 0x80);
+        delta >>= 7;
+    }
+
+    m_deltas << (quint8)delta;
+}
+
+void    xLineIndex::truncate(qint64 nLines) {
+    if (nLines >= m_count)
+        return;
+
+    if (nLines <= 0) {
+        clear();
+        return;
+    }
+
+    quint64 newLastPosition = position(nLines - 1);
+    quint64 nextPosition    = position(nLines);
+
+    m_deltas.resize(deltaOffset(nLines));
+    m_anchors.resize(((nLines - 1) >> m_blockShift) + 1);
+
+    m_count        = nLines;
+    m_lastPosition = newLastPosition;
+    m_lastLength   = nextPosition - newLastPosition;
+}
+
+quint64     xLineIndex::position(qint64 line) const {
+    const blockAnchor & anchor = m_anchors[line >> m_blockShift];
+
+    quint64         value = anchor.position;
+    const quint8 *  pData = m_deltas.constData(anchor.offset);
+
+    for (int i = line & m_blockMask; i > 0; i--) {
+        value += decodeDelta(pData);
+    }
+
+    return value;
+}
+
+int     xLineIndex::length(qint64 line) const {
+    int     nLength = 0;
+    xLineIndex::line(line, nullptr, &nLength);
+    return nLength;
+}
+
+void    xLineIndex::line(qint64 line, quint64 * position, int * length) const {
+    const blockAnchor & anchor = m_anchors[line >> m_blockShift];
+
+    quint64         value = anchor.position;
+    const quint8 *  pData = m_deltas.constData(anchor.offset);
+
+    for (int i = line & m_blockMask; i > 0; i--) {
+        value += decodeDelta(pData);
+    }
+
+    if (position)
+        *position = value;
+
+    if (!length)
+        return;
+
+    if (line == m_count - 1) {
+        *length = m_lastLength;
+    }
+    else if (((line + 1) & m_blockMask) == 0) {
+        *length = m_anchors[(line + 1) >> m_blockShift].position - value;
+    }
+    else {
+        *length = decodeDelta(pData);
+    }
+}
+
+quint64     xLineIndex::deltaOffset(qint64 line) const {
+    if (line >= m_count)
+        return m_deltas.size();
+
+    const blockAnchor & anchor = m_anchors[line >> m_blockShift];
+    const quint8 *      pStart = m_deltas.constData(anchor.offset);
+    const quint8 *      pData  = pStart;
+
+    for (int i = (line & m_blockMask) - 1; i > 0; i--) {
+        decodeDelta(pData);
+    }
+
+    return anchor.offset + (pData - pStart);
+}
+
+qint64  xLineIndex::findBlock(quint64 pos) const {
+    qint64  nLow  = 0;
+    qint64  nHigh = m_anchors.size();
+
+    while (nLow < nHigh) {
+        qint64 nMiddle = (nLow + nHigh) / 2;
+        if (pos < m_anchors[nMiddle].position) {
+            nHigh = nMiddle;
+        }
+        else {
+            nLow = nMiddle + 1;
+        }
+    }
+
+    return nLow - 1;
+}
+
+qint64  xLineIndex::lineByPosition(quint64 pos) const {
+    if (!m_count || (pos >= m_lastPosition + m_lastLength))
+        return -1;
+
+    qint64 nBlock = findBlock(pos);
+    if (nBlock < 0)
+        return -1;
+
+    qint64          nLine = nBlock << m_blockShift;
+    quint64         value = m_anchors[nBlock].position;
+    const quint8 *  pData = m_deltas.constData(m_anchors[nBlock].offset);
+
+    while ((nLine + 1 < m_count) && ((nLine + 1) & m_blockMask)) {
+        quint64 next = value + decodeDelta(pData);
+        if (next > pos)
+            break;
+
+        value = next;
+        nLine++;
+    }
+
+    return nLine;
+}
+
+qint64  xLineIndex::lowerBound(quint64 pos) const {
+    qint64 nBlock = findBlock(pos);
+    if (nBlock < 0)
+        return 0;
+
+    qint64          nLine = nBlock << m_blockShift;
+    quint64         value = m_anchors[nBlock].position;
+    const quint8 *  pData = m_deltas.constData(m_anchors[nBlock].offset);
+
+    while ((value < pos) && (nLine < m_count)) {
+        nLine++;
+        if ((nLine >= m_count) || !(nLine & m_blockMask))
+            break;
+
+        value += decodeDelta(pData);
+    }
+
+    return nLine;
+}
+
+quint64     xLineIndex::memoryUsage() const {
+    return m_anchors.memoryUsage() + m_deltas.memoryUsage();
+}
+
+// anchors are written field by field, so stream byte order applies to them,
+// deltas are single bytes and go as they are
+
+bool    xLineIndex::write(QDataStream & stream) const {
+    stream << (qint64)m_count << m_lastPosition << (qint32)m_lastLength << (qint64)m_anchors.size() << (qint64)m_deltas.size();
+
+    for (qint64 i = 0; i < m_anchors.size(); i++) {
+        const blockAnchor & anchor = m_anchors.at(i);
+        stream << anchor.position << anchor.offset;
+    }
+
+    return (stream.status() == QDataStream::Ok) && m_deltas.writeRaw(stream);
+}
+
+bool    xLineIndex::read(QDataStream & stream) {
+    qint64  nCount       = 0;
+    qint32  nLastLength  = 0;
+    qint64  nAnchors     = 0;
+    qint64  nDeltas      = 0;
+    quint64 lastPosition = 0;
+
+    clear();
+
+    stream >> nCount >> lastPosition >> nLastLength >> nAnchors >> nDeltas;
+
+    if ((stream.status() != QDataStream::Ok) || (nCount < 0) || (nAnchors != ((nCount + m_blockMask) >> m_blockShift)) || (nDeltas < 0))
+        return false;
+
+    for (qint64 i = 0; i < nAnchors; i++) {
+        blockAnchor anchor;
+        stream >> anchor.position >> anchor.offset;
+
+        if ((stream.status() != QDataStream::Ok) || (anchor.offset > (quint64)nDeltas)) {
+            clear();
+            return false;
+        }
+
+        m_anchors << anchor;
+    }
+
+    if (!m_deltas.readRaw(stream, nDeltas)) {
+        clear();
+        return false;
+    }
+
+    m_count        = nCount;
+    m_lastPosition = lastPosition;
+    m_lastLength   = nLastLength;
+
+    return true;
+}
@@ -0,0 +1,96 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xLineIndex_h_
+#define _xLineIndex_h_  1
+
+#include <QVector>
+#include <QDataStream>
+
+#include "xsegmentedvector.h"
+
+class xLineIndex {
+public:
+
+    xLineIndex();
+    ~xLineIndex();
+
+    qint64      size() const {
+        return m_count;
+    }
+
+    bool        isEmpty() const {
+        return m_count == 0;
+    }
+
+    void        clear();
+    void        append(quint64 position, int length);
+    void        truncate(qint64 nLines);
+
+    quint64     position(qint64 line) const;
+    int         length(qint64 line) const;
+    void        line(qint64 line, quint64 * position, int * length) const;
+
+    quint64     lastPosition() const {
+        return m_lastPosition;
+    }
+
+    int         lastLength() const {
+        return m_lastLength;
+    }
+
+    qint64      lineByPosition(quint64 pos) const;
+    qint64      lowerBound(quint64 pos) const;
+
+    quint64     memoryUsage() const;
+
+    bool        write(QDataStream & stream) const;
+    bool        read(QDataStream & stream);
+
+protected:
+
+    struct blockAnchor {
+        quint64     position = 0;
+        quint64     offset   = 0;
+    };
+
+    static  const   int         m_blockShift = 6;
+    static  const   int         m_blockMask  = (1 << m_blockShift) - 1;
+
+    // deltas of one block never cross segment boundary, so block
+    // is decoded through plain pointer, 10 bytes is longest 64 bit varint
+
+    static  const   int         m_maxBlockDeltaSize = m_blockMask * 10;
+
+    void        appendDelta(quint64 delta);
+    quint64     deltaOffset(qint64 line) const;
+    qint64      findBlock(quint64 pos) const;
+
+    xSegmentedVector<blockAnchor, 12>   m_anchors;
+    xSegmentedVector<quint8, 16>        m_deltas;
+
+    qint64                  m_count         = 0;
+    quint64                 m_lastPosition  = 0;
+    int                     m_lastLength    = 0;
+};
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <cstring>
+
+#include "xlinescanner.h"
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG) || defined(Q_CC_MSVC))
+ #define X_LINESCANNER_X86   1
+ #include <immintrin.h>
+ #ifdef Q_CC_MSVC
+  #include <intrin.h>
+  #define X_TARGET_AVX2
+ #else
+  #define X_TARGET_AVX2     __attribute__((target("avx2")))
+ #endif
+#endif
+
+static const char *    findNewlineScalar(const char * pBegin, const char * pEnd) {
+    const void * pFound = memchr(pBegin, 0x0A, pEnd - pBegin);
+    return pFound ? (const char *)pFound : pEnd;
+}
+
+#ifdef X_LINESCANNER_X86
+
+static inline int   firstBit(quint32 mask) {
+#ifdef Q_CC_MSVC
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static const char *    findNewlineSSE2(const char * pBegin, const char * pEnd) {
+    const __m128i   newline = _mm_set1_epi8(0x0A);
+
+    while (pEnd - pBegin >= 32) {
+        __m128i     low  = _mm_loadu_si128((const __m128i *)pBegin);
+        __m128i     high = _mm_loadu_si128((const __m128i *)(pBegin + 16));
+
+        quint32     mask = (quint32)_mm_movemask_epi8(_mm_cmpeq_epi8(low, newline)) |
+                           ((quint32)_mm_movemask_epi8(_mm_cmpeq_epi8(high, newline)) << 16);
+        if (mask)
+            return pBegin + firstBit(mask);
+
+        pBegin += 32;
+    }
+
+    return findNewlineScalar(pBegin, pEnd);
+}
+
+X_TARGET_AVX2 static const char *    findNewlineAVX2(const char * pBegin, const char * pEnd) {
+    const __m256i   newline = _mm256_set1_epi8(0x0A);
+
+    while (pEnd - pBegin >= 64) {
+        quint32     lowMask  = (quint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)pBegin), newline));
+        quint32     highMask = (quint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(pBegin + 32)), newline));
+
+        if (lowMask)
+            return pBegin + firstBit(lowMask);
+
+        if (highMask)
+            return pBegin + 32 + firstBit(highMask);
+
+        pBegin += 64;
+    }
+
+    return findNewlineSSE2(pBegin, pEnd);
+}
+
+static bool     cpuSupportsAVX2() {
+#ifdef Q_CC_MSVC
+    int info[4] = { 0 };
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    bool bOsSaveEnabled = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+    if (!bOsSaveEnabled || ((_xgetbv(0) & 0x06) != 0x06))
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+xLineScanner::ScanFunction     xLineScanner::selectImplementation() {
+#ifdef X_LINESCANNER_X86
+    if (cpuSupportsAVX2())
+        return findNewlineAVX2;
+
+    return findNewlineSSE2;
+#else
+    return findNewlineScalar;
+#endif
+}
+
+const char *    xLineScanner::findNewline(const char * pBegin, const char * pEnd) {
+    static const ScanFunction   scan = selectImplementation();
+    return scan(pBegin, pEnd);
+}
+
+const char *    xLineScanner::implementationName() {
+    ScanFunction  scan = selectImplementation();
+#ifdef X_LINESCANNER_X86
+    if (scan == findNewlineAVX2)
+        return "AVX2";
+    if (scan == findNewlineSSE2)
+        return "SSE2";
+#endif
+    Q_UNUSED(scan);
+    return "scalar";
+}
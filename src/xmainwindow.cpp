@@ -10,6 +10,7 @@
 #include <QMessageBox>
 #include <QRandomGenerator>
 #include <QFontDialog>
+#include <QInputDialog>
 #include <QProgressBar>
 #include <QStatusBar>
 #include <QSettings>
@@ -37,9 +38,13 @@ xMainWindow::xMainWindow(QWidget * pParent) :
 
     setCentralWidget(m_tabDocuments);
 
+    m_globalSearch = new xGlobalSearch(this);
+    connect(m_globalSearch, &xGlobalSearch::message, this, &xMainWindow::showMessage);
+
     createMenu();
 
     m_infoPanel = new xInfoPanel();
+    m_infoPanel->globalFindResults()->setModel(m_globalSearch->results());
 
     connect(m_infoPanel, &xInfoPanel::toggleHighlighterVisibility, this, &xMainWindow::onToggledHighlighterVisibility);
     connect(m_infoPanel, &xInfoPanel::toggleFilterRuleVisibility, this, &xMainWindow::onToggledFilterRuleVisibility);
@@ -49,6 +54,9 @@ xMainWindow::xMainWindow(QWidget * pParent) :
     connect(m_infoPanel, &xInfoPanel::changeHighlighterColor, this, &xMainWindow::onChangeHighlighterColor);
     connect(m_infoPanel, &xInfoPanel::ensureBookmarkVisible, this, &xMainWindow::ensureBookmarkVisible);
     connect(m_infoPanel, &xInfoPanel::ensureSearchResultVisible, this, &xMainWindow::ensureSearchResultVisible);
+    connect(m_infoPanel, &xInfoPanel::ensureGlobalSearchResultVisible, this, &xMainWindow::ensureGlobalSearchResultVisible);
+    connect(m_infoPanel, &xInfoPanel::cancelGlobalSearchRequest, m_globalSearch, &xGlobalSearch::cancel);
+    connect(m_infoPanel, &xInfoPanel::clearGlobalSearchRequest, m_globalSearch, &xGlobalSearch::clear);
     connect(m_infoPanel, &xInfoPanel::deleteFilterRequest, this, &xMainWindow::onDeleteFilterRequest);
     connect(m_infoPanel, &xInfoPanel::deleteAllFiltersRequest, this, &xMainWindow::onDeleteAllFiltersRequest);
 
@@ -99,8 +107,10 @@ void    xMainWindow::onCurrentDocumentChanged(int /*nIndex*/) {
     showMessage(QString());
 
     disconnect(m_currentProgress);
+    disconnect(m_resultCacheConnection);
 
     if (!pViewer) {
+        m_infoPanel->setResultCacheStatistics(0, 0, m_resultCacheBudget);
         m_viewerActions->setDisabled(true);
         m_infoPanel->bookmarks()->setModel(nullptr);
         m_infoPanel->findResults()->setModel(nullptr);
@@ -124,6 +134,12 @@ void    xMainWindow::onCurrentDocumentChanged(int /*nIndex*/) {
     m_infoPanel->filters()->setModel(pViewer->document()->filters());
     m_infoPanel->highlighters()->setModel(pViewer->highlighter()->highlighters());
 
+    xDocument * pDocument = pViewer->document();
+    m_infoPanel->setResultCacheStatistics(pDocument->resultCacheHits(), pDocument->resultCacheMisses(), pDocument->resultCacheBudget());
+    m_resultCacheConnection = connect(pDocument, &xDocument::resultCacheChanged, m_infoPanel, [this, pDocument]() {
+        m_infoPanel->setResultCacheStatistics(pDocument->resultCacheHits(), pDocument->resultCacheMisses(), pDocument->resultCacheBudget());
+    });
+
     m_currentProgress->setValue(pViewer->document()->currentOperationProgress());
     m_currentProgress->setVisible((pViewer->document()->currentOperationProgress()) > 0 && (pViewer->document()->currentOperationProgress() < 100));
 
@@ -183,6 +199,7 @@ xDocument *    xMainWindow::appendDocument(const QString & fileName) {
     xDocument * pNewDocument = new xDocument(pViewer); 
 
     connect(pNewDocument, &xDocument::message, this, &xMainWindow::showMessage);
+    pNewDocument->setResultCacheBudget(m_resultCacheBudget);
     
     pNewDocument->setFilePath(absolutePath);
     pViewer->setDocument(pNewDocument);
@@ -422,6 +439,37 @@ void            xMainWindow::createMenu() {
     m_viewerActions->addAction(m_copyAction);
     pMenu->addAction(m_copyAction);
 
+    pAction = new QAction(tr("Go to position..."), this);
+    pAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_G));
+    pAction->setStatusTip(tr("Jump to byte offset or percentage of file"));
+
+    connect(pAction, &QAction::triggered, [this]() {
+        xPlainTextViewer * pViewer = currentViewer();
+        if (!pViewer)
+            return;
+
+        bool    bOk = false;
+        QString position = QInputDialog::getText(this, tr("Go to position"), tr("Byte offset or percentage (e.g. 50%):"), QLineEdit::Normal, QString(), &bOk).trimmed();
+        if (!bOk || position.isEmpty())
+            return;
+
+        if (position.endsWith('%')) {
+            double percentage = position.chopped(1).toDouble(&bOk);
+            if (bOk) {
+                pViewer->jumpToPercentage(percentage);
+            }
+        }
+        else {
+            quint64 offset = position.toULongLong(&bOk);
+            if (bOk) {
+                pViewer->jumpToPosition(offset);
+            }
+        }
+    });
+
+    m_viewerActions->addAction(pAction);
+    pMenu->addAction(pAction);
+
     connect(pMenu, &QMenu::aboutToShow, [this]() {
         xPlainTextViewer * pViewer = currentViewer();
         m_copyAction->setEnabled(pViewer && pViewer->hasSelection());
@@ -447,6 +495,38 @@ void            xMainWindow::createMenu() {
     m_viewerActions->addAction(m_searchPanel);
     pMenu->addAction(m_searchPanel);
 
+    pAction = new QAction(tr("Find next"), this);
+    pAction->setShortcut(QKeySequence(Qt::Key_F3));
+    pAction->setStatusTip(tr("Jump to next occurrence of search pattern"));
+    connect(pAction, &QAction::triggered, [this]() {
+        currentViewer()->findNext();
+    });
+    pMenu->addAction(pAction);
+    m_viewerActions->addAction(pAction);
+
+    pAction = new QAction(tr("Find previous"), this);
+    pAction->setShortcut(QKeySequence(Qt::SHIFT + Qt::Key_F3));
+    pAction->setStatusTip(tr("Jump to previous occurrence of search pattern"));
+    connect(pAction, &QAction::triggered, [this]() {
+        currentViewer()->findPrevious();
+    });
+    pMenu->addAction(pAction);
+    m_viewerActions->addAction(pAction);
+
+    pMenu->addSeparator();
+
+    pAction = new QAction(tr("Find in all files"), this);
+    pAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F));
+    pAction->setStatusTip(tr("Search pattern in all opened files"));
+    connect(pAction, &QAction::triggered, this, &xMainWindow::onFindInAllFiles);
+    pMenu->addAction(pAction);
+    m_viewerActions->addAction(pAction);
+
+    pAction = new QAction(tr("Stop search in files"), this);
+    pAction->setStatusTip(tr("Stop search in all opened files"));
+    connect(pAction, &QAction::triggered, m_globalSearch, &xGlobalSearch::cancel);
+    pMenu->addAction(pAction);
+
     connect(pMenu, &QMenu::aboutToShow, [this]() {
         xPlainTextViewer * pViewer = currentViewer();
         m_searchPanel->setChecked(pViewer && pViewer->isSearchPanelShown());
@@ -516,7 +596,7 @@ void            xMainWindow::createMenu() {
         xPlainTextViewer * pViewer = currentViewer();
         if (pViewer) {
 
-            int nCurrentHover = pViewer->hoveredLineNumber();
+            qint64 nCurrentHover = pViewer->hoveredLineNumber();
             if (nCurrentHover >= 0) {
                 pViewer->toggleBookmark(nCurrentHover, Qt::red);
                 pViewer->viewport()->update();
@@ -721,7 +801,7 @@ void    xMainWindow::onViewerContextMenuRequested(const QPoint& pt) {
     toggleBookmarkMatch.setDisabled(pViewer->hoveredLineNumber() == -1);
 
     connect(&toggleBookmarkMatch, &QAction::triggered, [pt, pViewer, this]() {       
-            int nLine = pViewer->logicalLineForPosition(pt);
+            qint64 nLine = pViewer->logicalLineForPosition(pt);
 
             if (nLine >= 0) {
                 if (pViewer->toggleBookmark(nLine, Qt::red)) {
@@ -848,6 +928,7 @@ void            xMainWindow::saveSettings() {
     
     settings.setValue("main/recent files", QVariant::fromValue<QStringList>(m_recentFiles.toVector().toList()));
     settings.setValue("main/recent markups", QVariant::fromValue<QStringList>(m_recentMarkups.toVector().toList()));
+    settings.setValue("main/result cache MB", m_resultCacheBudget / (1024 * 1024));
 
 }
 //-------------------------------------------------
@@ -866,6 +947,11 @@ void            xMainWindow::restoreSettings() {
     for (const QString & fileName : recentFiles) {
         m_recentMarkups << fileName;
     }
+
+    // search and filter results are cached per document up to this size
+
+    m_resultCacheBudget = qMax<qint64>(0, settings.value("main/result cache MB", m_resultCacheBudget / (1024 * 1024)).toLongLong()) * 1024 * 1024;
+    m_infoPanel->setResultCacheStatistics(0, 0, m_resultCacheBudget);
 }
 
 void    xMainWindow::onTabCloseRequested(int index) {
@@ -882,6 +968,45 @@ void   xMainWindow::ensureSearchResultVisible(const searchResult & item) {
     }
 }
 
+void   xMainWindow::ensureGlobalSearchResultVisible(const globalSearchResult & item) {
+    if (!item.document)
+        return;
+
+    xPlainTextViewer * pViewer = viewer(item.document->filePath());
+    if (pViewer) {
+        m_tabDocuments->setCurrentWidget(pViewer);
+        pViewer->ensureSearchResultVisible(item.result);
+    }
+}
+
+void   xMainWindow::onFindInAllFiles() {
+    xPlainTextViewer * pViewer = currentViewer();
+    if (!pViewer)
+        return;
+
+    bool bOk = false;
+    searchRequestItem   item = pViewer->searchPanel()->currentSearchItem(&bOk);
+    if (!bOk) {
+        pViewer->showSearchPanel();
+        showMessage(tr("Enter search pattern first"), 3000);
+        return;
+    }
+
+    QVector<xDocument*>     documents;
+    QVector<QByteArray>     encodings;
+
+    for (int i = 0; i < m_tabDocuments->count(); i++) {
+        xPlainTextViewer * pTabViewer = qobject_cast<xPlainTextViewer*>(m_tabDocuments->widget(i));
+        if (pTabViewer && pTabViewer->document()) {
+            documents << pTabViewer->document();
+            encodings << pTabViewer->textCodec()->name();
+        }
+    }
+
+    m_globalSearch->search(documents, encodings, item);
+    m_infoPanel->activateGlobalFindResults();
+}
+
 void   xMainWindow::ensureBookmarkVisible(const documentBookmark & item) {
     xPlainTextViewer * pViewer = currentViewer();
     if (pViewer) {
@@ -8,6 +8,7 @@
 #include "xplaintextviewer.h"
 #include "xdocument.h"
 #include "xhighlighter.h"
+#include "xglobalsearch.h"
 
 class QTabWidget;
 class QToolBar;
@@ -57,6 +58,9 @@ public slots:
 
     void    ensureBookmarkVisible(const documentBookmark & item);
     void    ensureSearchResultVisible(const searchResult & item);
+    void    ensureGlobalSearchResultVisible(const globalSearchResult & item);
+
+    void    onFindInAllFiles();
    
 protected:
 
@@ -91,8 +95,11 @@ protected:
     QToolBar               *    m_toolDocuments      = nullptr;
 
     xInfoPanel             *    m_infoPanel          = nullptr;
+    xGlobalSearch          *    m_globalSearch       = nullptr;
 
     QProgressBar           *    m_currentProgress    = nullptr;
+    QMetaObject::Connection     m_resultCacheConnection;
+    qint64                      m_resultCacheBudget  = 64 * 1024 * 1024;
 
     QActionGroup           *    m_viewerActions      = nullptr;    
 
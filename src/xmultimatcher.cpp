@@ -0,0 +1,200 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QQueue>
+
+#include "xmultimatcher.h"
+
+xMultiMatcher::xMultiMatcher() {
+    clear();
+}
+
+void    xMultiMatcher::clear() {
+    m_nodes.clear();
+    m_nodes << node();
+    m_patterns.clear();
+    m_rootTable.fill(0, 256);
+    m_bBytes = false;
+    m_bFold  = false;
+}
+
+int     xMultiMatcher::addPattern(const QString & pattern, Qt::CaseSensitivity cs) {
+    Q_ASSERT(!m_bBytes || m_patterns.isEmpty());
+
+    QVector<ushort> units(pattern.size());
+    for (int i = 0; i < pattern.size(); i++) {
+        units[i] = pattern.at(i).unicode();
+    }
+
+    m_bBytes = false;
+    return addUnits(units, cs);
+}
+
+int     xMultiMatcher::addPattern(const QByteArray & pattern, Qt::CaseSensitivity cs) {
+    Q_ASSERT(m_bBytes || m_patterns.isEmpty());
+
+    QVector<ushort> units(pattern.size());
+    for (int i = 0; i < pattern.size(); i++) {
+        units[i] = (uchar)pattern.at(i);
+    }
+
+    m_bBytes = true;
+    return addUnits(units, cs);
+}
+
+int     xMultiMatcher::addUnits(const QVector<ushort> & units, Qt::CaseSensitivity cs) {
+    patternData pattern;
+    pattern.units = units;
+    pattern.cs    = cs;
+    m_patterns << pattern;
+
+    return m_patterns.size() - 1;
+}
+
+void    xMultiMatcher::build() {
+    m_nodes.clear();
+    m_nodes << node();
+    m_rootTable.fill(0, 256);
+
+    m_bFold = false;
+    for (const patternData & pattern : m_patterns) {
+        m_bFold |= (pattern.cs == Qt::CaseInsensitive);
+    }
+
+    // trie of (folded) patterns, empty patterns never match
+
+    for (int nPattern = 0; nPattern < m_patterns.size(); nPattern++) {
+        const QVector<ushort> & units = m_patterns[nPattern].units;
+        if (units.isEmpty())
+            continue;
+
+        int nNode = 0;
+        for (ushort unit : units) {
+            if (m_bFold)
+                unit = fold(unit);
+
+            int nChild = child(nNode, unit);
+            if (!nChild) {
+                nChild = m_nodes.size();
+                m_nodes << node();
+                setChild(nNode, unit, nChild);
+            }
+            nNode = nChild;
+        }
+
+        m_nodes[nNode].patterns << nPattern;
+    }
+
+    // failure and dictionary links, breadth first
+
+    QQueue<int> queue;
+    for (const edge & e : m_nodes[0].edges) {
+        queue.enqueue(e.node);
+    }
+
+    while (!queue.isEmpty()) {
+        int nNode = queue.dequeue();
+
+        for (const edge & e : m_nodes[nNode].edges) {
+            int nFail = m_nodes[nNode].fail;
+            int nNext;
+            while (((nNext = child(nFail, e.unit)) == 0) && nFail) {
+                nFail = m_nodes[nFail].fail;
+            }
+
+            node & childNode   = m_nodes[e.node];
+            childNode.fail     = nNext;
+            childNode.dictLink = m_nodes[nNext].patterns.isEmpty() ? m_nodes[nNext].dictLink : nNext;
+
+            queue.enqueue(e.node);
+        }
+    }
+}
+
+int     xMultiMatcher::child(int nNode, ushort unit) const {
+    if (!nNode && (unit < 256))
+        return m_rootTable[unit];
+
+    const QVector<edge> & edges = m_nodes[nNode].edges;
+
+    int nLow  = 0;
+    int nHigh = edges.size() - 1;
+    while (nLow <= nHigh) {
+        int nMiddle = (nLow + nHigh) / 2;
+        if (edges[nMiddle].unit == unit)
+            return edges[nMiddle].node;
+
+        if (edges[nMiddle].unit < unit)
+            nLow = nMiddle + 1;
+        else
+            nHigh = nMiddle - 1;
+    }
+
+    return 0;
+}
+
+void    xMultiMatcher::setChild(int nNode, ushort unit, int nChild) {
+    if (!nNode && (unit < 256)) {
+        m_rootTable[unit] = nChild;
+    }
+
+    QVector<edge> & edges = m_nodes[nNode].edges;
+
+    edge e;
+    e.unit = unit;
+    e.node = nChild;
+
+    auto it = std::lower_bound(edges.begin(), edges.end(), e, [](const edge & a, const edge & b) {
+        return a.unit < b.unit;
+    });
+    edges.insert(it, e);
+}
+
+QVector<xMultiMatcher::match>   xMultiMatcher::findAll(const QString & text) const {
+    QVector<match>  result;
+
+    scan(text.utf16(), text.size(), [&result](int nPattern, int nStart, int nLength) {
+        match m;
+        m.pattern = nPattern;
+        m.start   = nStart;
+        m.length  = nLength;
+        result << m;
+        return true;
+    });
+
+    return result;
+}
+
+bool    xMultiMatcher::containsAll(const QString & text) const {
+    return containsAllUnits(text.utf16(), text.size());
+}
+
+bool    xMultiMatcher::containsAll(const char * pData, int length) const {
+    return containsAllUnits((const uchar *)pData, length);
+}
+
+int     xMultiMatcher::matchingPatterns(const QString & text, bool * pFound) const {
+    return matchingUnits(text.utf16(), text.size(), pFound);
+}
+
+int     xMultiMatcher::matchingPatterns(const char * pData, int length, bool * pFound) const {
+    return matchingUnits((const uchar *)pData, length, pFound);
+}
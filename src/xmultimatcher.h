@@ -0,0 +1,180 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xMultiMatcher_h_
+#define _xMultiMatcher_h_  1
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QVarLengthArray>
+
+// Aho-Corasick automaton, finds all occurrences of many literal patterns
+// in one pass, patterns are either all QString or all encoded bytes;
+// case insensitive patterns are matched on folded text, case sensitive
+// ones are verified against original text if folding is active
+
+class xMultiMatcher {
+public:
+
+    struct match {
+        int     pattern = 0;
+        int     start   = 0;
+        int     length  = 0;
+    };
+
+    xMultiMatcher();
+
+    void        clear();
+
+    int         addPattern(const QString & pattern, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    int         addPattern(const QByteArray & pattern, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    void        build();
+
+    int         patternCount() const {
+        return m_patterns.size();
+    }
+
+    bool        isEmpty() const {
+        return m_patterns.isEmpty();
+    }
+
+    QVector<match>  findAll(const QString & text) const;
+
+    bool        containsAll(const QString & text) const;
+    bool        containsAll(const char * pData, int length) const;
+
+    int         matchingPatterns(const QString & text, bool * pFound) const;
+    int         matchingPatterns(const char * pData, int length, bool * pFound) const;
+
+protected:
+
+    struct edge {
+        ushort  unit  = 0;
+        int     node  = 0;
+    };
+
+    struct node {
+        QVector<edge>   edges;
+        QVector<int>    patterns;
+        int             fail      = 0;
+        int             dictLink  = -1;
+    };
+
+    struct patternData {
+        QVector<ushort>         units;
+        Qt::CaseSensitivity     cs = Qt::CaseSensitive;
+    };
+
+    int         addUnits(const QVector<ushort> & units, Qt::CaseSensitivity cs);
+    int         child(int nNode, ushort unit) const;
+    void        setChild(int nNode, ushort unit, int nChild);
+
+    ushort      fold(ushort unit) const {
+        if (m_bBytes)
+            return ((unit >= 'A') && (unit <= 'Z')) ? unit + ('a' - 'A') : unit;
+
+        return QChar::isSurrogate(unit) ? unit : (ushort)QChar::toLower((uint)unit);
+    }
+
+    template <typename Unit, typename Callback> void scan(const Unit * pText, int length, Callback onMatch) const {
+        int nState = 0;
+
+        for (int i = 0; i < length; i++) {
+            ushort  unit = (ushort)pText[i];
+            if (m_bFold)
+                unit = fold(unit);
+
+            int nNext;
+            while (((nNext = child(nState, unit)) == 0) && nState) {
+                nState = m_nodes[nState].fail;
+            }
+            nState = nNext;
+
+            int nOutput = m_nodes[nState].patterns.isEmpty() ? m_nodes[nState].dictLink : nState;
+            while (nOutput >= 0) {
+                for (int nPattern : m_nodes[nOutput].patterns) {
+                    const patternData & pattern = m_patterns[nPattern];
+                    int nLength = pattern.units.size();
+                    int nStart  = i - nLength + 1;
+
+                    if (m_bFold && (pattern.cs == Qt::CaseSensitive)) {
+                        int j = 0;
+                        while ((j < nLength) && ((ushort)pText[nStart + j] == pattern.units[j])) {
+                            j++;
+                        }
+                        if (j != nLength)
+                            continue;
+                    }
+
+                    if (!onMatch(nPattern, nStart, nLength))
+                        return;
+                }
+                nOutput = m_nodes[nOutput].dictLink;
+            }
+        }
+    }
+
+    template <typename Unit> bool containsAllUnits(const Unit * pText, int length) const {
+        if (m_patterns.isEmpty())
+            return true;
+
+        QVarLengthArray<bool, 128>  found(m_patterns.size());
+        std::fill(found.begin(), found.end(), false);
+        int nFound = 0;
+
+        scan(pText, length, [&found, &nFound, this](int nPattern, int, int) {
+            if (!found[nPattern]) {
+                found[nPattern] = true;
+                nFound++;
+            }
+            return nFound < m_patterns.size();
+        });
+
+        return nFound == m_patterns.size();
+    }
+
+    template <typename Unit> int matchingUnits(const Unit * pText, int length, bool * pFound) const {
+        std::fill(pFound, pFound + m_patterns.size(), false);
+        int nFound = 0;
+
+        scan(pText, length, [pFound, &nFound, this](int nPattern, int, int) {
+            if (!pFound[nPattern]) {
+                pFound[nPattern] = true;
+                nFound++;
+            }
+            return nFound < m_patterns.size();
+        });
+
+        return nFound;
+    }
+
+protected:
+
+    bool                    m_bBytes = false;
+    bool                    m_bFold  = false;
+    QVector<node>           m_nodes;
+    QVector<patternData>    m_patterns;
+    QVector<int>            m_rootTable;
+};
+
+#endif
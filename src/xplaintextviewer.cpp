@@ -37,9 +37,20 @@
 //------------------------------------------------------------------------
 xPlainTextViewer::xPlainTextViewer(QWidget * pParent):
     QAbstractScrollArea(pParent) {
-    setVerticalScrollBar(new xScrollBar(this));
-    verticalScrollBar()->setMinimum(0);
-    verticalScrollBar()->setSingleStep(1);
+    m_scrollBar = new xScrollBar(this);
+    setVerticalScrollBar(m_scrollBar);
+    m_scrollBar->setMinimum(0);
+    m_scrollBar->setSingleStep(1);
+
+    connect(m_scrollBar, &xScrollBar::sparseValueChanged, [this](double fraction) {
+        jumpToPercentage(fraction * 100.);
+    });
+    connect(m_scrollBar, &xScrollBar::sparseScrollTriggered, [this](int nLines) {
+        scrollSparseView(nLines);
+    });
+    connect(m_scrollBar, &xScrollBar::logicalValueChanged, [this](qint64 /* value */) {
+        viewport()->update();
+    });
 
     setMinimumHeight(300);
     setMinimumWidth(500);
@@ -82,22 +93,24 @@ void       xPlainTextViewer::setDocument(xDocument * pDocument) {
     if (m_document == pDocument)
         return;
 
-    xScrollBar * pScrollBar = qobject_cast<xScrollBar*>(verticalScrollBar());
-
     if (m_document) {
         disconnect(m_document, nullptr, this, nullptr);
-        if (pScrollBar) {
-            pScrollBar->setMarksModel(nullptr);
-        }
+        disconnect(m_document, nullptr, m_scrollBar, nullptr);
+        m_scrollBar->setMarksModel(nullptr);
     }
 
     m_document = pDocument;
    
-    if (pScrollBar) {
-        pScrollBar->setMarksModel(bookmarks());
-    }
+    m_scrollBar->setMarksModel(bookmarks());
 
     connect(m_document, &xDocument::layoutChanged, this, &xPlainTextViewer::onLayoutChanged);
+    connect(m_document, &xDocument::linesAppended, this, &xPlainTextViewer::onLinesAppended);
+    connect(m_document, &xDocument::occurrenceFound, this, &xPlainTextViewer::onOccurrenceFound);
+    connect(m_document, &xDocument::densityChanged, m_scrollBar, &xScrollBar::invalidateDensity);
+
+    m_bFindPositionValid = false;
+
+    updateDensityRules();
 
     invalidate();
 }
@@ -109,34 +122,62 @@ xDocument * xPlainTextViewer::document() const {
 void    xPlainTextViewer::onLayoutChanged() {
     setUpdatesEnabled(false);
     setMaximumScrollBarValue();
+    if (m_bSparseView && m_document->isPositionIndexed(m_sparsePosition)) {
+        jumpToPosition(m_sparsePosition);
+    }
+
     if (m_bFollowTail) {
-        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        leaveSparseView();
+        m_scrollBar->setLogicalValue(m_scrollBar->logicalMaximum());
     }
     
     m_bookmarkModel->layoutChanged();
     setUpdatesEnabled(true);
 }
 
+void    xPlainTextViewer::onLinesAppended(qint64 firstLine, qint64 /*count*/) {
+    qint64 nTopLine = m_scrollBar->logicalValue();
+
+    // appended lines always end up on bottom screen, so lines that fit
+    // from bottom are measured again, it costs one screen of lines at most
+
+    setMaximumScrollBarValue();
+
+    if (m_bSparseView && m_document->isPositionIndexed(m_sparsePosition)) {
+        jumpToPosition(m_sparsePosition);
+    }
+
+    if (m_bFollowTail) {
+        leaveSparseView();
+        m_scrollBar->setLogicalValue(m_scrollBar->logicalMaximum());
+    }
+
+    if (m_bFollowTail || (firstLine <= nTopLine + viewport()->height() / fontMetrics().height() + 1)) {
+        viewport()->update();
+    }
+}
+
 void        xPlainTextViewer::setMaximumScrollBarValue() {
-    QScrollBar * pScrollBar = verticalScrollBar();
     int nLinesToFitFromBottom = logicalLinesToFitFromBottom();
     if (m_document) {
-        int nMax = m_document->logicalLinesCount() - nLinesToFitFromBottom;
+        qint64 nMax = m_document->logicalLinesCount() - nLinesToFitFromBottom;
 
         if (nMax < 0)
             nMax = 0;
 
-        pScrollBar->setMaximum(nMax);
+        m_scrollBar->setLogicalMaximum(nMax);
     }
     else {
-        pScrollBar->setMaximum(0);
+        m_scrollBar->setLogicalMaximum(0);
     }
 }
 
 void       xPlainTextViewer::invalidate() {    
     setUpdatesEnabled(false);   
+    m_bSparseView = false;
+    m_scrollBar->leaveSparse();
     setMaximumScrollBarValue();
-    verticalScrollBar()->setValue(0);
+    m_scrollBar->setLogicalValue(0);
     setUpdatesEnabled(true);
 }
 
@@ -201,9 +242,47 @@ quint64 xPlainTextViewer::logicalSelectionLength() const {
 }
 
 void    xPlainTextViewer::onHighlightRulesChanged() {
+    updateDensityRules();
     viewport()->update();
 }
 
+void    xPlainTextViewer::updateDensityRules() {
+    if (!m_document)
+        return;
+
+    // current search goes first, then active highlighters, position
+    // highlighters do not depend on content and are not shown
+
+    QVector<searchRequestItem>  items;
+    QVector<QColor>             colors;
+
+    auto appendItem = [&items, &colors](const highlighterItem & item, const QColor & color) {
+        searchRequestItem   request;
+        request.type    = (item.type == PatternHighlighter) ? PatternSearch : RegExpSearch;
+        request.matcher = item.matcher;
+        request.regexp  = item.regexp;
+
+        items  << request;
+        colors << color;
+    };
+
+    if (m_searchHighlighter.isActive) {
+        appendItem(m_searchHighlighter, m_searchHighlighter.format.background().color());
+    }
+
+    if (m_highligher) {
+        for (const highlighterItem & item : m_highligher->highlighters()->items()) {
+            if (!item.isActive || (item.type == PositionHighlighter))
+                continue;
+
+            appendItem(item, item.format.foreground().color());
+        }
+    }
+
+    m_scrollBar->setDensityColors(colors);
+    m_document->setDensityRules(items, m_codec->name());
+}
+
 quint64     xPlainTextViewer::indexAtPoint(const QPoint & pt, int * column, bool * bFound) const {
     if (bFound) {
         *bFound = false;
@@ -303,7 +382,7 @@ void  xPlainTextViewer::mouseMoveEvent(QMouseEvent *event) {
         }
     }
     else {
-        int nCurrentHoveredLine = logicalLineForPosition(event->pos(), false);
+        qint64 nCurrentHoveredLine = logicalLineForPosition(event->pos(), false);
         if (m_currentHoverLine != nCurrentHoveredLine) {
             m_currentHoverLine = nCurrentHoveredLine;
             qCDebug(logicViewer) << "xPlainTextViewer: hover line changed: " << m_currentHoverLine;
@@ -316,7 +395,7 @@ void  xPlainTextViewer::mouseMoveEvent(QMouseEvent *event) {
 
 void  xPlainTextViewer::timerEvent(QTimerEvent *event) {
     if (event->timerId() == m_scrollTimer) {
-        verticalScrollBar()->setValue(verticalScrollBar()->value() + m_scrollDelta);
+        m_scrollBar->setLogicalValue(m_scrollBar->logicalValue() + m_scrollDelta);
         bool bFound = false;
         int  nColumn = 0;
         quint64 charPosition = indexAtPoint(m_lastPosition, &nColumn, &bFound);
@@ -383,7 +462,7 @@ bool xPlainTextViewer::selectWord(const QPoint & pt) {
     if (!document())
         return false;
 
-    int nLine = logicalLineForPosition(pt);
+    qint64 nLine = logicalLineForPosition(pt);
     if (nLine == -1)
         return false;
 
@@ -426,7 +505,7 @@ bool xPlainTextViewer::selectWord(const QPoint & pt) {
     return false;
 }
 
-QString  xPlainTextViewer::logicalLineText(int index) const {
+QString  xPlainTextViewer::logicalLineText(qint64 index) const {
     return m_codec->toUnicode(document()->logicalLine(index));
 }
 
@@ -451,7 +530,7 @@ void xPlainTextViewer::mouseDoubleClickEvent(QMouseEvent *event) {
 
     if (event->button() == Qt::LeftButton) {
         if (event->pos().x() < leftSpacing) {
-            int nLine = logicalLineForPosition(event->pos());
+            qint64 nLine = logicalLineForPosition(event->pos());
             if (nLine != -1) {
                 selectLogicalLine(nLine);
                 viewport()->update();
@@ -465,7 +544,7 @@ void xPlainTextViewer::mouseDoubleClickEvent(QMouseEvent *event) {
     }
 }
 
-bool xPlainTextViewer::selectLogicalLine(int line) {
+bool xPlainTextViewer::selectLogicalLine(qint64 line) {
     if (!document())
         return false;
 
@@ -482,9 +561,9 @@ bool xPlainTextViewer::selectLogicalLine(int line) {
     return true;
 }
 
-void                xPlainTextViewer::ensureLogicalLineVisible(int line) {
+void                xPlainTextViewer::ensureLogicalLineVisible(qint64 line) {
     if (line >= 0) {
-        verticalScrollBar()->setValue(line);
+        m_scrollBar->setLogicalValue(line);
     }
 }
 
@@ -496,9 +575,88 @@ void    xPlainTextViewer::ensureBookmarkVisible(const documentBookmark & item) {
     ensureLogicalLineVisible(document()->sourceToLogicalLineNumber(item.lineNumber));
 }
 
+quint64 xPlainTextViewer::currentPosition() const {
+    if (!m_document)
+        return 0;
+
+    if (m_bSparseView)
+        return m_sparsePosition;
+
+    return m_document->logicalLinePosition(m_scrollBar->logicalValue());
+}
+
+void    xPlainTextViewer::jumpToPosition(quint64 position) {
+    if (!m_document)
+        return;
+
+    if (m_document->fileSize() && (position >= m_document->fileSize())) {
+        position = m_document->fileSize() - 1;
+    }
+
+    qint64 nLine = m_document->logicalLineByPosition(position);
+    if (nLine >= 0) {
+        m_bSparseView = false;
+        m_scrollBar->leaveSparse();
+        ensureLogicalLineVisible(nLine);
+        viewport()->update();
+        return;
+    }
+
+    // position is not indexed yet, show lines resolved
+    // around it until index will reach this position
+
+    m_sparsePosition = m_document->resolveLineStart(position);
+    m_bSparseView    = true;
+
+    if (m_document->fileSize()) {
+        m_scrollBar->setSparsePosition(m_sparsePosition / (double)m_document->fileSize());
+    }
+
+    qCDebug(logicViewer) << "xPlainTextViewer: sparse view at position: " << m_sparsePosition;
+
+    viewport()->update();
+}
+
+void    xPlainTextViewer::jumpToPercentage(double percentage) {
+    if (!m_document)
+        return;
+
+    jumpToPosition(m_document->fileSize() * qBound(0., percentage, 100.) / 100.);
+}
+
+bool    xPlainTextViewer::isSparseView() const {
+    return m_bSparseView;
+}
+
+void    xPlainTextViewer::leaveSparseView() {
+    if (m_bSparseView) {
+        m_bSparseView = false;
+        m_scrollBar->leaveSparse();
+        viewport()->update();
+    }
+}
+
+void    xPlainTextViewer::scrollSparseView(int nLines) {
+    quint64 position = m_sparsePosition;
+
+    if (nLines > 0) {
+        linesData lines = m_document->resolveLines(position, nLines + 1);
+        if (lines.size()) {
+            position = lines[qMin(nLines, lines.size() - 1)].position;
+        }
+    }
+    else {
+        for (int i = 0; (i < -nLines) && (position > 0); i++) {
+            position = m_document->resolveLineStart(position - 1);
+        }
+    }
+
+    jumpToPosition(position);
+}
+
 int         xPlainTextViewer::logicalLinesToFitFromBottom() const {
     
-    int nCurrentLine = document()->logicalLinesCount() - 1;
+    qint64 nCurrentLine = document()->logicalLinesCount() - 1;
     if (nCurrentLine < 0)
         return 0;
 
@@ -536,7 +694,7 @@ int         xPlainTextViewer::logicalLinesToFitFromBottom() const {
         nCurrentLine--;
     } while (currentY > 0 && nCurrentLine >= 0);
 
-    int nLines = document()->logicalLinesCount() - 1 - nCurrentLine;
+    int nLines = (int)(document()->logicalLinesCount() - 1 - nCurrentLine);
 
     if ((currentY < -m_lineSpacing) && (nLines > 0)) {
         nLines--;
@@ -558,7 +716,7 @@ void    xPlainTextViewer::paintEvent(QPaintEvent * /*event*/) {
         return;
     }
 
-    int currentScrollBarValue = verticalScrollBar()->value();
+    qint64 currentScrollBarValue = m_scrollBar->logicalValue();
    
     QFontMetrics   metrics      = fontMetrics();
     int            textHeight   = metrics.height();
@@ -566,9 +724,22 @@ void    xPlainTextViewer::paintEvent(QPaintEvent * /*event*/) {
     int            linesEstimation = windowHeight / textHeight+1;
     int            digitWidth   = metrics.width("0");
 
-    m_lineNumbersSpacing = digitWidth * 6;
+    m_lineNumbersSpacing = digitWidth * qMax(6, QString::number(m_document->logicalLinesCount()).length() + 1);
+
+    QVector<QByteArray>     lines;
+    linesData               sparseLines;
+    qint64                  sparseLineNumber = -1;
 
-    QVector<QByteArray>     lines = m_document->logicalLines(currentScrollBarValue, currentScrollBarValue + linesEstimation);
+    if (m_bSparseView) {
+        sparseLines      = m_document->resolveLines(m_sparsePosition, linesEstimation + 1);
+        sparseLineNumber = m_document->estimatedLineNumber(m_sparsePosition);
+        for (const lineData & line : sparseLines) {
+            lines << m_document->text(line.position, line.position + line.length);
+        }
+    }
+    else {
+        lines = m_document->logicalLines(currentScrollBarValue, currentScrollBarValue + linesEstimation);
+    }
     
     int            leftSpacing = (m_bShowBookmarks ? m_bookmarkSpacing : 0) + (m_bShowLineNumbers ? m_lineNumbersSpacing : 0) + m_leftSpacing;
     int            currentY = m_topSpacing;
@@ -590,17 +761,22 @@ void    xPlainTextViewer::paintEvent(QPaintEvent * /*event*/) {
     quint64 selectionStart = qMin(m_selectionStart, m_selectionEnd);
     quint64 selectionEnd   = qMax(m_selectionStart, m_selectionEnd);
     
-    int nCurrentLineNumber = currentScrollBarValue;
-    quint64 layoutPosition = m_document->logicalLinePosition(nCurrentLineNumber);
+    qint64 nCurrentLineNumber = currentScrollBarValue;
+    quint64 layoutPosition = m_bSparseView ? m_sparsePosition : m_document->logicalLinePosition(nCurrentLineNumber);
 
-    for (const QByteArray & lineData : lines) {
+    for (int nLine = 0; nLine < lines.size(); nLine++) {
+        const QByteArray & lineData = lines[nLine];
+
+        if (m_bSparseView) {
+            layoutPosition = sparseLines[nLine].position;
+        }
 
-        int sourceLineNumber = document()->logicalToSourceLineNumber(nCurrentLineNumber);
-        if (sourceLineNumber == -1)
+        qint64 sourceLineNumber = m_bSparseView ? sparseLineNumber : document()->logicalToSourceLineNumber(nCurrentLineNumber);
+        if (sourceLineNumber == -1 && !m_bSparseView)
             continue;
 
         if (m_bShowLineNumbers) {                      
-            QString lineNumberString = QString("%1").arg(sourceLineNumber+1);
+            QString lineNumberString = m_bSparseView ? (sparseLineNumber < 0 ? QString("~") : QString("~%1").arg(sparseLineNumber + nLine + 1)) : QString("%1").arg(sourceLineNumber+1);
             painter.setPen(Qt::darkCyan);
             painter.drawText(lineNumberX, currentY, m_lineNumbersSpacing, textHeight + metrics.lineSpacing(), Qt::AlignRight, lineNumberString);
         }
@@ -615,7 +791,7 @@ void    xPlainTextViewer::paintEvent(QPaintEvent * /*event*/) {
             }
         }
 
-        if (m_bShowBookmarks) {
+        if (m_bShowBookmarks && !m_bSparseView) {
             if (hasBookmark(nCurrentLineNumber)) {
                 QIcon markIcon = style()->standardIcon(QStyle::SP_ArrowRight);
                 markIcon.paint(&painter, 0, currentY, m_bookmarkSpacing, textHeight, Qt::AlignRight | Qt::AlignVCenter);
@@ -670,7 +846,7 @@ void    xPlainTextViewer::paintEvent(QPaintEvent * /*event*/) {
         painter.setPen(Qt::black);
         textLayout->draw(&painter, QPoint(leftSpacing, m_topSpacing));
 
-        if (nCurrentLineNumber == m_currentHoverLine) {
+        if (!m_bSparseView && (nCurrentLineNumber == m_currentHoverLine)) {
             painter.setPen(Qt::lightGray);
             QRectF r = textLayout->boundingRect();            
             painter.drawRect(r.x() + leftSpacing, r.y()+m_leftSpacing/2, r.width()-2, r.height());
@@ -696,6 +872,24 @@ void    xPlainTextViewer::resizeEvent(QResizeEvent *event) {
 
 void xPlainTextViewer::wheelEvent(QWheelEvent *e)
 {   
+    // high resolution wheels and touchpads send deltas smaller than one
+    // notch of 120, they are summed until they make at least one line
+
+    int nLines = 0;
+    if (!(e->modifiers() & Qt::CTRL)) {
+        m_wheelRemainder -= e->angleDelta().y() * QApplication::wheelScrollLines();
+        nLines            = m_wheelRemainder / 120;
+        m_wheelRemainder -= nLines * 120;
+    }
+
+    if (m_bSparseView && !(e->modifiers() & Qt::CTRL)) {
+        if (nLines) {
+            scrollSparseView(nLines);
+        }
+        e->accept();
+        return;
+    }
+
     if (e->modifiers() & Qt::CTRL) {
         if (e->delta() > 0) {
             QFont ft = viewport()->font();
@@ -720,10 +914,15 @@ void xPlainTextViewer::wheelEvent(QWheelEvent *e)
         return;
     }
 
-    QAbstractScrollArea::wheelEvent(e);
+    // scroll by lines explicitly, scroll bar steps may be scaled for huge documents
+
+    if (nLines) {
+        m_scrollBar->setLogicalValue(m_scrollBar->logicalValue() + nLines);
+    }
+    e->accept();
 }
 
-int                 xPlainTextViewer::logicalLinesInSelection() const {
+qint64              xPlainTextViewer::logicalLinesInSelection() const {
     if (!hasSelection())
         return 0;
 
@@ -752,18 +951,21 @@ int                  xPlainTextViewer::selectionColumnStart() const {
     return m_selectionColumnStart;
 }
 
-int                 xPlainTextViewer::logicalLineForPosition(const QPoint & pt, bool bExact) const {
+qint64              xPlainTextViewer::logicalLineForPosition(const QPoint & pt, bool bExact) const {
+    if (m_bSparseView)
+        return -1;
+
     int nLine = 0;
     for (const QPair<QSharedPointer<QTextLayout>, quint64> & layoutInfo : m_currentLayouts) {
         if (layoutInfo.first->boundingRect().contains(pt)) {
             if (!bExact) {
-                return verticalScrollBar()->value() + nLine;
+                return m_scrollBar->logicalValue() + nLine;
             }
 
             for (int i = 0; i < layoutInfo.first->lineCount(); i++) {                
                 const QTextLine & line = layoutInfo.first->lineAt(i);
                 if (line.rect().contains(pt)) {                    
-                    return verticalScrollBar()->value()+nLine;
+                    return m_scrollBar->logicalValue() + nLine;
                 }                
             }
         }
@@ -773,7 +975,7 @@ int                 xPlainTextViewer::logicalLineForPosition(const QPoint & pt,
     return -1;
 }
 
-int xPlainTextViewer::hoveredLineNumber() const {
+qint64 xPlainTextViewer::hoveredLineNumber() const {
     return m_currentHoverLine;
 }
 
@@ -784,6 +986,7 @@ QString             xPlainTextViewer::hoveredLine() const {
 void xPlainTextViewer::setTextCodec(QTextCodec * pCodec)
 {
     m_codec = pCodec;
+    updateDensityRules();
     viewport()->update();
 }
 
@@ -798,7 +1001,7 @@ void                xPlainTextViewer::setFollowTail(bool f) {
     m_bFollowTail = f;
 
     if (m_bFollowTail) {
-        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        m_scrollBar->setLogicalValue(m_scrollBar->logicalMaximum());
         viewport()->update();
     }
 }
@@ -807,7 +1010,7 @@ QTextCodec * xPlainTextViewer::textCodec() const {
     return m_codec;
 }
 
-bool                xPlainTextViewer::hasBookmark(int nLine) const {
+bool                xPlainTextViewer::hasBookmark(qint64 nLine) const {
     nLine = document()->logicalToSourceLineNumber(nLine);
     QVector<documentBookmark>::const_iterator it = std::find_if(m_bookmarkModel->items().begin(), m_bookmarkModel->items().end(), [nLine](const documentBookmark & bookmark) {
         return bookmark.lineNumber == nLine;
@@ -816,7 +1019,7 @@ bool                xPlainTextViewer::hasBookmark(int nLine) const {
     return (it != m_bookmarkModel->items().end());
 }
 
-bool                xPlainTextViewer::toggleBookmark(int nLine, const QColor & color) {
+bool                xPlainTextViewer::toggleBookmark(qint64 nLine, const QColor & color) {
     nLine = document()->logicalToSourceLineNumber(nLine);
     QVector<documentBookmark>::const_iterator it = std::find_if(m_bookmarkModel->items().begin(), m_bookmarkModel->items().end(), [nLine](const documentBookmark & bookmark) {
         return bookmark.lineNumber == nLine;
@@ -845,12 +1048,12 @@ bool                xPlainTextViewer::toggleBookmark(int nLine, const QColor & c
     return false;
 }
 
-int                  xPlainTextViewer::previousBookmark(int nLine) const {
+qint64               xPlainTextViewer::previousBookmark(qint64 nLine) const {
     if (nLine == -1)
-        nLine = verticalScrollBar()->value();
+        nLine = m_scrollBar->logicalValue();
 
     nLine = document()->logicalToSourceLineNumber(nLine);   
-    int nPreviousLine = -1;
+    qint64 nPreviousLine = -1;
     std::find_if(m_bookmarkModel->items().begin(), m_bookmarkModel->items().end(), [nLine, &nPreviousLine](const documentBookmark & item) { 
         if (item.lineNumber < nLine) {
             nPreviousLine = item.lineNumber;
@@ -863,18 +1066,18 @@ int                  xPlainTextViewer::previousBookmark(int nLine) const {
         nPreviousLine = m_bookmarkModel->items().last().lineNumber;
 
     if (nPreviousLine != -1) {
-        verticalScrollBar()->setValue(nPreviousLine);
+        m_scrollBar->setLogicalValue(nPreviousLine);
     }
 
     return nPreviousLine;
 }
 
-int                  xPlainTextViewer::nextBookmark(int nLine) const {
+qint64               xPlainTextViewer::nextBookmark(qint64 nLine) const {
     if (nLine == -1)
-        nLine = verticalScrollBar()->value();
+        nLine = m_scrollBar->logicalValue();
 
     nLine = document()->logicalToSourceLineNumber(nLine);
-    int nNextLine = -1;
+    qint64 nNextLine = -1;
 
     QVector<documentBookmark>::const_iterator it = std::find_if(m_bookmarkModel->items().begin(), m_bookmarkModel->items().end(), [nLine](const documentBookmark & item) {
        return item.lineNumber > nLine;
@@ -890,7 +1093,7 @@ int                  xPlainTextViewer::nextBookmark(int nLine) const {
     }
 
     if (nNextLine != -1) {
-        verticalScrollBar()->setValue(nNextLine);
+        m_scrollBar->setLogicalValue(nNextLine);
     }
 
     
@@ -972,6 +1175,7 @@ void                    xPlainTextViewer::showSearchPanel() {
 void                    xPlainTextViewer::hideSearchPanel() {
     m_searchPanel->hide();
     m_searchHighlighter.isActive = false;
+    updateDensityRules();
     viewport()->update();
 }
 
@@ -980,6 +1184,8 @@ xSearchWidget   *       xPlainTextViewer::searchPanel() const {
 }
 
 void    xPlainTextViewer::onSearchChanged(const searchRequestItem & item) {
+    m_bFindPositionValid = false;
+
     if (item.type == PatternSearch) {
         m_searchHighlighter.matcher     = item.matcher;
         m_searchHighlighter.type        = PatternHighlighter;
@@ -991,7 +1197,11 @@ void    xPlainTextViewer::onSearchChanged(const searchRequestItem & item) {
         m_searchHighlighter.type        = RegExtHighlighter;
         m_searchHighlighter.isActive    = true;
     }
+    else {
+        m_searchHighlighter.isActive    = false;
+    }
 
+    updateDensityRules();
     viewport()->update();
 }
 
@@ -1008,6 +1218,44 @@ void    xPlainTextViewer::onAddFilter(const searchRequestItem & item) {
     emit showFilters();
 }
 
+void    xPlainTextViewer::findNext() {
+    bool bOk = false;
+    searchRequestItem   item = m_searchPanel->currentSearchItem(&bOk);
+    if (!bOk || !m_document)
+        return;
+
+    // continue from last found line while it is on screen,
+    // otherwise from the top of the view
+
+    quint64 position = currentPosition();
+    if (m_bFindPositionValid && m_currentLayouts.size() && (m_findPosition >= m_currentLayouts.first().second) && (m_findPosition <= m_currentLayouts.last().second)) {
+        position = m_findPosition + 1;
+    }
+
+    m_document->findOccurrence(item, m_codec->name(), position, false);
+}
+
+void    xPlainTextViewer::findPrevious() {
+    bool bOk = false;
+    searchRequestItem   item = m_searchPanel->currentSearchItem(&bOk);
+    if (!bOk || !m_document)
+        return;
+
+    quint64 position = currentPosition();
+    if (m_bFindPositionValid && m_currentLayouts.size() && (m_findPosition >= m_currentLayouts.first().second) && (m_findPosition <= m_currentLayouts.last().second)) {
+        position = m_findPosition;
+    }
+
+    m_document->findOccurrence(item, m_codec->name(), position, true);
+}
+
+void    xPlainTextViewer::onOccurrenceFound(const searchResult & item) {
+    m_findPosition       = item.position;
+    m_bFindPositionValid = true;
+
+    jumpToPosition(item.position);
+}
+
 void    xPlainTextViewer::onFindAll(const searchRequestItem & item) {
     m_document->search(item, m_codec->name(), false);
     emit showFindResults();
@@ -1015,7 +1263,7 @@ void    xPlainTextViewer::onFindAll(const searchRequestItem & item) {
 
 
 void    xPlainTextViewer::initModels() {
-    m_bookmarkModel->setColumntCount(4);
+    m_bookmarkModel->setColumnCount(4);
 
     connect(m_bookmarkModel, &QAbstractItemModel::rowsInserted, [this]() {
         viewport()->update();
@@ -42,7 +42,7 @@ enum {
 };
 
 struct documentBookmark {
-    int         lineNumber = 0;
+    qint64      lineNumber = 0;
     QString     value;
     QString     name;
     QColor      color = Qt::red;
@@ -84,31 +84,36 @@ public:
     int                 selectionColumnStart() const;
 
     quint64             logicalSelectionLength() const;
-    int                 logicalLinesInSelection() const;
+    qint64              logicalLinesInSelection() const;
 
-    int                 logicalLineForPosition(const QPoint & pt, bool bExact = true) const;
-    bool                selectLogicalLine(int line);
+    qint64              logicalLineForPosition(const QPoint & pt, bool bExact = true) const;
+    bool                selectLogicalLine(qint64 line);
     bool                selectWord(const QPoint & pt);
         
     QString             hoveredLine() const;
-    int                 hoveredLineNumber() const;
+    qint64              hoveredLineNumber() const;
 
-    QString             logicalLineText(int index) const;
+    QString             logicalLineText(qint64 index) const;
         
-    void                ensureLogicalLineVisible(int line);
+    void                ensureLogicalLineVisible(qint64 line);
     void                ensureBookmarkVisible(const documentBookmark & item);
     void                ensureSearchResultVisible(const searchResult & item);
 
+    void                jumpToPosition(quint64 position);
+    quint64             currentPosition() const;
+    void                jumpToPercentage(double percentage);
+    bool                isSparseView() const;
+
     QTextCodec      *   textCodec() const;
     void                setTextCodec(QTextCodec * pCodec);
 
     bool                followTail() const;
     void                setFollowTail(bool f);
 
-    bool                    hasBookmark(int nLine) const;
-    bool                    toggleBookmark(int nLine, const QColor & color);
-    int                     previousBookmark(int nLine = -1) const;
-    int                     nextBookmark(int nLine = -1) const;
+    bool                    hasBookmark(qint64 nLine) const;
+    bool                    toggleBookmark(qint64 nLine, const QColor & color);
+    qint64                  previousBookmark(qint64 nLine = -1) const;
+    qint64                  nextBookmark(qint64 nLine = -1) const;
     QAbstractTableModel *   bookmarks() const { return m_bookmarkModel; };
 
     void                    setTimestampFormat(const QString & format, int start, int length);
@@ -118,6 +123,9 @@ public:
     int                     timestampPosition() const;
     int                     timestampLength() const;
 
+    void                    findNext();
+    void                    findPrevious();
+
     bool                    isSearchPanelShown() const;
     void                    showSearchPanel();
     void                    hideSearchPanel();
@@ -126,8 +134,10 @@ public:
 public slots:
 
     void    onLayoutChanged();
+    void    onLinesAppended(qint64 firstLine, qint64 count);
     void    onHighlightRulesChanged();
     void    onSearchChanged(const searchRequestItem & item);
+    void    onOccurrenceFound(const searchResult & item);
 
     void    onAddFilter(const searchRequestItem & item);
     void    onFindAll(const searchRequestItem & item);
@@ -155,10 +165,13 @@ protected:
     quint64     indexAtPoint(const QPoint & pt, int * column, bool * bFound) const;
     int         logicalLinesToFitFromBottom() const;
     void        setMaximumScrollBarValue();
+    void        leaveSparseView();
+    void        scrollSparseView(int nLines);
     void        initModels();
+    void        updateDensityRules();
 
 protected:
-    int             m_currentHoverLine    = -1;
+    qint64          m_currentHoverLine    = -1;
 
     int             m_maximumFontSize     = 18;
     int             m_minimumFontSize     = 6;
@@ -187,7 +200,15 @@ protected:
     bool            m_bShowLineNumbers = true;
     bool            m_bFollowTail      = false;
 
+    bool            m_bSparseView      = false;
+    int             m_wheelRemainder   = 0;
+    quint64         m_sparsePosition   = 0;
+
+    bool            m_bFindPositionValid = false;
+    quint64         m_findPosition       = 0;
+
     xDocument        * m_document   = nullptr;
+    xScrollBar       * m_scrollBar  = nullptr;
     xHighlighter     * m_highligher = nullptr;
     QTextCodec       * m_codec      = nullptr;
     
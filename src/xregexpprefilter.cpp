@@ -0,0 +1,251 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "xregexpprefilter.h"
+
+static const int    minimalLiteralLength = 2;
+
+QString     xRegExpPrefilter::requiredLiteral(const QRegularExpression & regexp) {
+    if (!regexp.isValid() || (regexp.patternOptions() & QRegularExpression::ExtendedPatternSyntaxOption))
+        return QString();
+
+    const QString   pattern = regexp.pattern();
+    QString         literal;
+    QString         run;
+
+    auto closeRun = [&literal, &run]() {
+        if (run.size() > literal.size())
+            literal = run;
+        run.clear();
+    };
+
+    int nPos = 0;
+    while (nPos < pattern.size()) {
+        QChar c = pattern.at(nPos);
+
+        // top level alternative makes any literal optional
+
+        if (c == '|')
+            return QString();
+
+        if ((c == '(') || (c == '[') || (c == '.') || (c == '^') || (c == '$')) {
+            if (c == '(') {
+                // inline options may change case sensitivity or syntax
+
+                if ((nPos + 2 < pattern.size()) && (pattern.at(nPos + 1) == '?') && QString("imsxnJU-^").contains(pattern.at(nPos + 2)))
+                    return QString();
+
+                nPos = skipGroup(pattern, nPos);
+            }
+            else if (c == '[') {
+                nPos = skipClass(pattern, nPos);
+            }
+            else {
+                nPos++;
+            }
+
+            bool bOptional = false;
+            if ((nPos < 0) || ((nPos = skipQuantifier(pattern, nPos, &bOptional)) < 0))
+                return QString();
+
+            closeRun();
+            continue;
+        }
+
+        if ((c == '*') || (c == '+') || (c == '?') || (c == '{') || (c == ')'))
+            return QString();
+
+        if (c == '\\') {
+            if (nPos + 1 >= pattern.size())
+                return QString();
+
+            c = pattern.at(nPos + 1);
+
+            if (c == 'Q')
+                return QString();
+
+            // escaped letters are classes, anchors or control characters,
+            // anything with arguments (hex codes, references) is not analyzed
+
+            if (c.isLetterOrNumber()) {
+                if (!QString("dDwWsSbBAzZGhHvVRXKtnrfae").contains(c))
+                    return QString();
+
+                bool bOptional = false;
+                nPos = skipQuantifier(pattern, nPos + 2, &bOptional);
+                if (nPos < 0)
+                    return QString();
+
+                closeRun();
+                continue;
+            }
+
+            nPos++;
+        }
+
+        nPos++;
+
+        bool bOptional = false;
+        int  nNext     = skipQuantifier(pattern, nPos, &bOptional);
+        if (nNext < 0)
+            return QString();
+
+        if (nNext == nPos) {
+            run += c;
+        }
+        else {
+            if (!bOptional)
+                run += c;
+            closeRun();
+        }
+
+        nPos = nNext;
+    }
+
+    closeRun();
+
+    return (literal.size() >= minimalLiteralLength) ? literal : QString();
+}
+
+searchRequestItem   xRegExpPrefilter::prefilterItem(const QRegularExpression & regexp) {
+    searchRequestItem   item;
+
+    QString literal = requiredLiteral(regexp);
+    if (literal.isEmpty())
+        return item;
+
+    item.type    = PatternSearch;
+    item.matcher = QStringMatcher(literal, (regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption) ? Qt::CaseInsensitive : Qt::CaseSensitive);
+
+    return item;
+}
+
+int     xRegExpPrefilter::skipGroup(const QString & pattern, int nPos) {
+    int nDepth = 0;
+
+    while (nPos < pattern.size()) {
+        QChar c = pattern.at(nPos);
+
+        if (c == '\\') {
+            nPos += 2;
+            continue;
+        }
+
+        if (c == '[') {
+            nPos = skipClass(pattern, nPos);
+            if (nPos < 0)
+                return -1;
+            continue;
+        }
+
+        if (c == '(') {
+            nDepth++;
+        }
+        else if (c == ')') {
+            if (--nDepth == 0)
+                return nPos + 1;
+        }
+
+        nPos++;
+    }
+
+    return -1;
+}
+
+int     xRegExpPrefilter::skipClass(const QString & pattern, int nPos) {
+    nPos++;
+
+    if ((nPos < pattern.size()) && (pattern.at(nPos) == '^'))
+        nPos++;
+
+    // closing bracket right after opening one is literal
+
+    if ((nPos < pattern.size()) && (pattern.at(nPos) == ']'))
+        nPos++;
+
+    while (nPos < pattern.size()) {
+        QChar c = pattern.at(nPos);
+
+        if (c == '\\') {
+            nPos += 2;
+            continue;
+        }
+
+        if ((c == '[') && (nPos + 1 < pattern.size()) && (pattern.at(nPos + 1) == ':')) {
+            int nEnd = pattern.indexOf(":]", nPos + 2);
+            if (nEnd < 0)
+                return -1;
+            nPos = nEnd + 2;
+            continue;
+        }
+
+        if (c == ']')
+            return nPos + 1;
+
+        nPos++;
+    }
+
+    return -1;
+}
+
+int     xRegExpPrefilter::skipQuantifier(const QString & pattern, int nPos, bool * pOptional) {
+    *pOptional = false;
+
+    if (nPos >= pattern.size())
+        return nPos;
+
+    QChar c = pattern.at(nPos);
+
+    if ((c == '*') || (c == '?')) {
+        *pOptional = true;
+        nPos++;
+    }
+    else if (c == '+') {
+        nPos++;
+    }
+    else if (c == '{') {
+        int nEnd = pattern.indexOf('}', nPos);
+        if (nEnd < 0)
+            return nPos;
+
+        QString bounds = pattern.mid(nPos + 1, nEnd - nPos - 1);
+        bool    bOk    = false;
+        int     nMin   = bounds.section(',', 0, 0).toInt(&bOk);
+
+        // not a quantifier, PCRE treats brace as literal
+
+        if (!bOk && !bounds.startsWith(','))
+            return -1;
+
+        *pOptional = (nMin == 0);
+        nPos = nEnd + 1;
+    }
+    else {
+        return nPos;
+    }
+
+    // lazy and possessive forms
+
+    if ((nPos < pattern.size()) && ((pattern.at(nPos) == '?') || (pattern.at(nPos) == '+')))
+        nPos++;
+
+    return nPos;
+}
@@ -0,0 +1,48 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xRegExpPrefilter_h_
+#define _xRegExpPrefilter_h_  1
+
+#include <QString>
+#include <QRegularExpression>
+
+#include "xdocument.h"
+
+// finds literal which must be present in any text matched by regular
+// expression, so lines without it can be skipped without running regexp;
+// analysis is conservative, nothing is returned if pattern is not understood
+
+class xRegExpPrefilter {
+public:
+
+    static QString              requiredLiteral(const QRegularExpression & regexp);
+    static searchRequestItem    prefilterItem(const QRegularExpression & regexp);
+
+protected:
+
+    static int                  skipGroup(const QString & pattern, int nPos);
+    static int                  skipClass(const QString & pattern, int nPos);
+    static int                  skipQuantifier(const QString & pattern, int nPos, bool * pOptional);
+};
+
+#endif
@@ -31,6 +31,9 @@
 xScrollBar::xScrollBar(xPlainTextViewer * pViewer, QWidget *parent)
     : QScrollBar(parent) {
     m_pViewer = pViewer;
+
+    connect(this, &QAbstractSlider::valueChanged, this, &xScrollBar::onValueChanged);
+    connect(this, &QAbstractSlider::actionTriggered, this, &xScrollBar::onActionTriggered);
 }
 
 void    xScrollBar::setMarksModel(QAbstractItemModel * pModel, int nColumn, int nRole) {
@@ -76,11 +79,256 @@ void xScrollBar::enableClipping(bool clip)
     m_isClipped = clip;
 }
 
+// slider range is limited by int, so when logical range does not fit
+// slider works in fixed range and logical value is kept separately,
+// steps and pages are applied to logical value directly to stay precise
+
+bool    xScrollBar::isScaled() const {
+    return m_logicalMaximum > m_sliderRange;
+}
+
+int     xScrollBar::toSliderValue(qint64 nValue) const {
+    if (!isScaled())
+        return nValue;
+
+    return qRound((double)nValue * m_sliderRange / m_logicalMaximum);
+}
+
+qint64  xScrollBar::toLogicalValue(int nValue) const {
+    if (!isScaled())
+        return nValue;
+
+    return qRound64((double)nValue * m_logicalMaximum / m_sliderRange);
+}
+
+void    xScrollBar::setLogicalMaximum(qint64 nMaximum) {
+    if (m_logicalMaximum != qMax<qint64>(0, nMaximum)) {
+        m_bDensityValid = false;
+    }
+
+    m_logicalMaximum = qMax<qint64>(0, nMaximum);
+
+    qint64 nValue = qBound<qint64>(0, m_logicalValue, m_logicalMaximum);
+    bool   bChanged = (nValue != m_logicalValue);
+    m_logicalValue = nValue;
+
+    updateSlider();
+
+    if (bChanged) {
+        emit logicalValueChanged(m_logicalValue);
+    }
+}
+
+qint64  xScrollBar::logicalMaximum() const {
+    return m_logicalMaximum;
+}
+
+void    xScrollBar::setLogicalValue(qint64 nValue) {
+    nValue = qBound<qint64>(0, nValue, m_logicalMaximum);
+    if (nValue == m_logicalValue)
+        return;
+
+    m_logicalValue = nValue;
+    updateSlider();
+
+    emit logicalValueChanged(m_logicalValue);
+}
+
+qint64  xScrollBar::logicalValue() const {
+    return m_logicalValue;
+}
+
+void    xScrollBar::updateSlider() {
+    if (m_bSparse)
+        return;
+
+    setMaximum(isScaled() ? m_sliderRange : m_logicalMaximum);
+    setValue(toSliderValue(m_logicalValue));
+}
+
+// in sparse view lines around shown position are not indexed yet, so slider
+// shows relative position in file instead of line number, moving it is
+// reported as fraction of file and steps as number of lines to scroll
+
+void    xScrollBar::setSparsePosition(double fraction) {
+    m_bSparse = true;
+
+    blockSignals(true);
+    setMaximum(m_sliderRange);
+    setValue(qRound(qBound(0., fraction, 1.) * m_sliderRange));
+    blockSignals(false);
+}
+
+void    xScrollBar::leaveSparse() {
+    if (!m_bSparse)
+        return;
+
+    m_bSparse = false;
+
+    blockSignals(true);
+    updateSlider();
+    blockSignals(false);
+}
+
+bool    xScrollBar::isSparse() const {
+    return m_bSparse;
+}
+
+void    xScrollBar::onValueChanged(int nValue) {
+    if (m_bSparse) {
+        emit sparseValueChanged(nValue / (double)m_sliderRange);
+        return;
+    }
+
+    if (toSliderValue(m_logicalValue) == nValue)
+        return;
+
+    m_logicalValue = qBound<qint64>(0, toLogicalValue(nValue), m_logicalMaximum);
+    emit logicalValueChanged(m_logicalValue);
+}
+
+void    xScrollBar::onActionTriggered(int nAction) {
+    if (!isScaled() && !m_bSparse)
+        return;
+
+    qint64 nDelta = 0;
+
+    switch (nAction) {
+    case QAbstractSlider::SliderSingleStepAdd:
+        nDelta = singleStep();
+        break;
+    case QAbstractSlider::SliderSingleStepSub:
+        nDelta = -singleStep();
+        break;
+    case QAbstractSlider::SliderPageStepAdd:
+        nDelta = pageStep();
+        break;
+    case QAbstractSlider::SliderPageStepSub:
+        nDelta = -pageStep();
+        break;
+    default:
+        return;
+    }
+
+    if (m_bSparse) {
+        setSliderPosition(value());
+        emit sparseScrollTriggered(nDelta);
+        return;
+    }
+
+    qint64 nValue = qBound<qint64>(0, m_logicalValue + nDelta, m_logicalMaximum);
+    if (nValue == m_logicalValue)
+        return;
+
+    m_logicalValue = nValue;
+    setSliderPosition(toSliderValue(m_logicalValue));
+
+    emit logicalValueChanged(m_logicalValue);
+}
+
+void    xScrollBar::setDensityColors(const QVector<QColor> & colors) {
+    if (m_densityColors == colors)
+        return;
+
+    m_densityColors = colors;
+    invalidateDensity();
+}
+
+void    xScrollBar::invalidateDensity() {
+    m_bDensityValid = false;
+    update();
+}
+
+// density image is one pixel wide strip, each pixel gets color of the rule
+// with highest relative density for lines shown at this pixel, alpha follows
+// that density, image is rebuilt only when density or geometry changes
+
+void    xScrollBar::updateDensityImage(int nHeight) {
+    if (m_bDensityValid && (m_densityImage.height() == nHeight))
+        return;
+
+    m_bDensityValid = true;
+    m_densityImage  = QImage();
+
+    xDocument * pDocument = m_pViewer->document();
+    if (!pDocument || (nHeight <= 0) || !m_logicalMaximum)
+        return;
+
+    const densityData & density = pDocument->density();
+    if (!density.cellSize)
+        return;
+
+    int nChannels = qMin(density.counts.size(), m_densityColors.size());
+
+    QVector< QVector<quint64> > prefixSums(nChannels);
+    for (int i = 0; i < nChannels; i++) {
+        const QVector<quint32> & counts = density.counts[i];
+        QVector<quint64> & sums = prefixSums[i];
+
+        sums.resize(counts.size() + 1);
+        sums[0] = 0;
+        for (int j = 0; j < counts.size(); j++) {
+            sums[j + 1] = sums[j] + counts[j];
+        }
+    }
+
+    qreal   sf      = nHeight / (qreal)m_logicalMaximum;
+    qint64  nLines  = pDocument->logicalLinesCount();
+
+    auto cellAt = [pDocument, &density, nLines](qint64 nLine) -> quint64 {
+        quint64 nPosition = (nLine < nLines) ? pDocument->logicalLinePosition(nLine) : pDocument->fileSize();
+        return nPosition / density.cellSize;
+    };
+
+    QVector< QVector<quint64> > pixels(nChannels, QVector<quint64>(nHeight));
+    QVector<quint64>            maximum(nChannels);
+
+    for (int y = 0; y < nHeight; y++) {
+        quint64 nFromCell = cellAt((qint64)(y / sf));
+        quint64 nToCell   = qMax(nFromCell + 1, cellAt((qint64)((y + 1) / sf)));
+
+        for (int i = 0; i < nChannels; i++) {
+            const QVector<quint64> & sums = prefixSums[i];
+            int     nLast  = sums.size() - 1;
+            quint64 nValue = sums[qMin<quint64>(nToCell, nLast)] - sums[qMin<quint64>(nFromCell, nLast)];
+
+            pixels[i][y] = nValue;
+            maximum[i]   = qMax(maximum[i], nValue);
+        }
+    }
+
+    m_densityImage = QImage(1, nHeight, QImage::Format_ARGB32_Premultiplied);
+    m_densityImage.fill(Qt::transparent);
+
+    for (int y = 0; y < nHeight; y++) {
+        int     nChannel   = -1;
+        qreal   nIntensity = 0;
+
+        for (int i = 0; i < nChannels; i++) {
+            if (!maximum[i])
+                continue;
+
+            qreal nValue = pixels[i][y] / (qreal)maximum[i];
+            if (nValue > nIntensity) {
+                nIntensity = nValue;
+                nChannel   = i;
+            }
+        }
+
+        if (nChannel == -1)
+            continue;
+
+        QColor  color = m_densityColors[nChannel];
+        color.setAlphaF(0.25 + 0.75 * nIntensity);
+        m_densityImage.setPixel(0, y, qPremultiply(color.rgba()));
+    }
+}
+
 void xScrollBar::paintEvent(QPaintEvent *event)
 {
     QScrollBar::paintEvent(event);
 
-    if (!m_marksModel)
+    if (!m_logicalMaximum)
         return;
 
     QStyleOptionSlider styleOption;
@@ -105,18 +353,23 @@ void xScrollBar::paintEvent(QPaintEvent *event)
         p.translate(qMin(subPage.left(), addPage.left()), 0.0);
 
         sf = (addPage.width() + subPage.width() + slider.width())
-            / ((qreal)maximum() - minimum());
+            / (qreal)m_logicalMaximum;
     } else {
         p.translate(0.0, qMin(subPage.top(), addPage.top()));
 
         sf = (addPage.height() + subPage.height() + slider.height())
-            / ((qreal)maximum() - minimum());
+            / (qreal)m_logicalMaximum;
+
+        updateDensityImage(addPage.height() + subPage.height() + slider.height());
+        if (!m_densityImage.isNull()) {
+            p.drawImage(QRect(slider.width() - m_densityWidth, 0, m_densityWidth, m_densityImage.height()), m_densityImage);
+        }
     }
 
-    if (m_pViewer->document()) {
+    if (m_marksModel && m_pViewer->document()) {
         int nRows = m_marksModel->rowCount();
         for (int i = 0; i < nRows; i++) {
-            int         nMarkPosition = m_marksModel->data(m_marksModel->index(i, m_marksColumn), Qt::DisplayRole).toInt();
+            qint64      nMarkPosition = m_marksModel->data(m_marksModel->index(i, m_marksColumn), Qt::DisplayRole).toLongLong();
             nMarkPosition = m_pViewer->document()->logicalToSourceLineNumber(nMarkPosition);
             if (nMarkPosition == -1)
                 continue;
@@ -25,6 +25,7 @@
 
 #include <QScrollBar>
 #include <QPaintEvent>
+#include <QImage>
 
 class QAbstractItemModel;
 class xPlainTextViewer;
@@ -45,10 +46,38 @@ public:
     bool isClipped() const;
     void enableClipping(bool clip);
 
+    void                    setLogicalMaximum(qint64 nMaximum);
+    qint64                  logicalMaximum() const;
+    void                    setLogicalValue(qint64 nValue);
+    qint64                  logicalValue() const;
+
+    void                    setSparsePosition(double fraction);
+    void                    leaveSparse();
+    bool                    isSparse() const;
+
+    void                    setDensityColors(const QVector<QColor> & colors);
+    void                    invalidateDensity();
+
+signals:
+
+    void                    logicalValueChanged(qint64 nValue);
+    void                    sparseValueChanged(double fraction);
+    void                    sparseScrollTriggered(int nLines);
+
 protected:
 
     virtual void paintEvent(QPaintEvent *event);
 
+    bool                    isScaled() const;
+    int                     toSliderValue(qint64 nValue) const;
+    qint64                  toLogicalValue(int nValue) const;
+    void                    updateSlider();
+
+    void                    updateDensityImage(int nHeight);
+
+    void                    onValueChanged(int nValue);
+    void                    onActionTriggered(int nAction);
+
 protected:
 
     QAbstractItemModel * m_marksModel   = nullptr;
@@ -56,6 +85,16 @@ protected:
     int                  m_marksRole    = -1;
     bool m_isClipped                    = true;
     xPlainTextViewer   * m_pViewer      = nullptr;
+
+    const int            m_sliderRange    = 1 << 30;
+    qint64               m_logicalMaximum = 0;
+    qint64               m_logicalValue   = 0;
+    bool                 m_bSparse        = false;
+
+    const int            m_densityWidth   = 4;
+    QVector<QColor>      m_densityColors;
+    QImage               m_densityImage;
+    bool                 m_bDensityValid  = false;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,182 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "xsearchresultlist.h"
+
+static inline quint64   decodeDelta(const quint8 *& pData) {
+    quint64     value = 0;
+    int         shift = 0;
+
+    while (*pData & 0x80) {
+        value |= (quint64)(*pData++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    return value | ((quint64)(*pData++) << shift);
+}
+
+bool    xSearchResultList::append(const searchResult & item) {
+    if (m_count && ((item.lineNumber <= m_last.lineNumber) || (item.position <= m_last.position)))
+        return false;
+
+    if ((m_count & m_blockMask) == 0) {
+        if (m_deltas.remainingInSegment() < m_maxBlockDeltaSize) {
+            m_deltas.resize(m_deltas.size() + m_deltas.remainingInSegment());
+        }
+
+        blockAnchor anchor;
+        anchor.lineNumber = item.lineNumber;
+        anchor.position   = item.position;
+        anchor.offset     = m_deltas.size();
+        m_anchors << anchor;
+    }
+    else {
+        appendDelta(item.lineNumber - m_last.lineNumber);
+        appendDelta(item.position - m_last.position);
+    }
+
+    m_lengths << (quint16)qBound(0, item.matchLength, 0xFFFF);
+    m_last = item;
+    m_count++;
+
+    return true;
+}
+
+void    xSearchResultList::appendDelta(quint64 delta) {
+    while (delta >= 0x80) {
+        m_deltas << (quint8)(delta | 0x80);
+        delta >>= 7;
+    }
+
+    m_deltas << (quint8)delta;
+}
+
+// offset of deltas of item, it is the first byte after items preceding it
+// in block, first item of block has no deltas and starts at anchor offset
+
+quint64     xSearchResultList::deltaOffset(qint64 index) const {
+    const blockAnchor & anchor = m_anchors[index >> m_blockShift];
+
+    const quint8 *  pStart = m_deltas.constData(anchor.offset);
+    const quint8 *  pData  = pStart;
+
+    for (int i = (index & m_blockMask) - 1; i > 0; i--) {
+        decodeDelta(pData);
+        decodeDelta(pData);
+    }
+
+    return anchor.offset + (pData - pStart);
+}
+
+void    xSearchResultList::truncate(qint64 nItems) {
+    if (nItems >= m_count)
+        return;
+
+    if (nItems <= 0) {
+        clear();
+        return;
+    }
+
+    searchResult    last = at(nItems - 1);
+
+    m_deltas.resize((nItems & m_blockMask) ? deltaOffset(nItems) : m_anchors[nItems >> m_blockShift].offset);
+    m_anchors.resize(((nItems - 1) >> m_blockShift) + 1);
+    m_lengths.resize(nItems);
+
+    m_count = nItems;
+    m_last  = last;
+}
+
+void    xSearchResultList::clear() {
+    m_anchors.clear();
+    m_deltas.clear();
+    m_lengths.clear();
+    m_count = 0;
+    m_last  = searchResult();
+}
+
+searchResult    xSearchResultList::at(qint64 index) const {
+    searchResult    item;
+    item.lineNumber = -1;
+
+    if ((index < 0) || (index >= m_count))
+        return item;
+
+    const blockAnchor & anchor = m_anchors[index >> m_blockShift];
+    const quint8 *      pData  = m_deltas.constData(anchor.offset);
+
+    item.lineNumber = anchor.lineNumber;
+    item.position   = anchor.position;
+
+    for (int i = index & m_blockMask; i > 0; i--) {
+        item.lineNumber += decodeDelta(pData);
+        item.position   += decodeDelta(pData);
+    }
+
+    item.matchLength = m_lengths[index];
+
+    return item;
+}
+
+qint64  xSearchResultList::lineNumber(qint64 index) const {
+    return at(index).lineNumber;
+}
+
+// index of the first item at or after position
+
+qint64  xSearchResultList::lowerBound(quint64 position) const {
+    if (!m_count || (position > m_last.position))
+        return m_count;
+
+    qint64 nLow  = 0;
+    qint64 nHigh = m_anchors.size();
+
+    while (nLow < nHigh) {
+        qint64 nMiddle = (nLow + nHigh) / 2;
+        if (m_anchors[nMiddle].position < position) {
+            nLow = nMiddle + 1;
+        }
+        else {
+            nHigh = nMiddle;
+        }
+    }
+
+    if (nLow == 0)
+        return 0;
+
+    // item is inside of previous block or it is the first of found one
+
+    qint64          nIndex = (nLow - 1) << m_blockShift;
+    quint64         value  = m_anchors[nLow - 1].position;
+    const quint8 *  pData  = m_deltas.constData(m_anchors[nLow - 1].offset);
+
+    while ((value < position) && (nIndex + 1 < m_count) && ((nIndex + 1) & m_blockMask)) {
+        decodeDelta(pData);
+        value += decodeDelta(pData);
+        nIndex++;
+    }
+
+    return (value < position) ? nIndex + 1 : nIndex;
+}
+
+quint64     xSearchResultList::memoryUsage() const {
+    return m_anchors.memoryUsage() + m_deltas.memoryUsage() + m_lengths.memoryUsage();
+}
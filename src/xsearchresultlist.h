@@ -0,0 +1,88 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xSearchResultList_h_
+#define _xSearchResultList_h_  1
+
+#include "xsegmentedvector.h"
+#include "xdocument.h"
+
+// compact list of search results ordered by position, line numbers and
+// positions are stored as varint deltas with anchor per block like in
+// xLineIndex, match lengths as 16 bit values, copies share storage
+
+class xSearchResultList {
+public:
+
+    qint64      size() const {
+        return m_count;
+    }
+
+    bool        isEmpty() const {
+        return m_count == 0;
+    }
+
+    qint64      lastLineNumber() const {
+        return m_count ? m_last.lineNumber : -1;
+    }
+
+    quint64     lastPosition() const {
+        return m_last.position;
+    }
+
+    // items have to follow previous one in line and position,
+    // item out of order is rejected
+
+    bool        append(const searchResult & item);
+    void        truncate(qint64 nItems);
+    void        clear();
+
+    searchResult    at(qint64 index) const;
+    qint64          lineNumber(qint64 index) const;
+    qint64          lowerBound(quint64 position) const;
+
+    quint64     memoryUsage() const;
+
+protected:
+
+    struct blockAnchor {
+        qint64      lineNumber = 0;
+        quint64     position   = 0;
+        quint64     offset     = 0;
+    };
+
+    static  const   int         m_blockShift = 6;
+    static  const   int         m_blockMask  = (1 << m_blockShift) - 1;
+    static  const   int         m_maxBlockDeltaSize = m_blockMask * 20;
+
+    void        appendDelta(quint64 delta);
+    quint64     deltaOffset(qint64 index) const;
+
+    xSegmentedVector<blockAnchor, 12>   m_anchors;
+    xSegmentedVector<quint8, 16>        m_deltas;
+    xSegmentedVector<quint16, 16>       m_lengths;
+
+    qint64              m_count = 0;
+    searchResult        m_last;
+};
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "xsearchresultsmodel.h"
+#include "xlog.h"
+
+xSearchResultsModel::xSearchResultsModel(QObject * pParent) :
+    xValueListModel(pParent) {
+}
+
+xSearchResultsModel::~xSearchResultsModel() {
+}
+
+void    xSearchResultsModel::appendItems(const searchResults & items) {
+    if (items.isEmpty())
+        return;
+
+    // results have to grow in position, item out of order would break
+    // row lookup, so it is dropped instead of being inserted
+
+    searchResults   accepted;
+    accepted.reserve(items.size());
+
+    quint64 nLastPosition = m_results.lastPosition();
+    qint64  nLastLine     = m_results.lastLineNumber();
+
+    for (const searchResult & item : items) {
+        if ((nLastLine >= 0) && ((item.lineNumber <= nLastLine) || (item.position <= nLastPosition))) {
+            qCDebug(logicDocument) << "xSearchResultsModel: out of order result at line " << item.lineNumber << " dropped";
+            continue;
+        }
+
+        accepted << item;
+        nLastLine     = item.lineNumber;
+        nLastPosition = item.position;
+    }
+
+    if (accepted.isEmpty())
+        return;
+
+    // list may hold more results than view can show, rows beyond int
+    // range are kept but never reported
+
+    int nFirstRow = visibleRows(m_results.size());
+    int nLastRow  = visibleRows(m_results.size() + accepted.size());
+
+    if (nLastRow > nFirstRow)
+        beginInsertRows(QModelIndex(), nFirstRow, nLastRow - 1);
+
+    for (const searchResult & item : accepted) {
+        m_results.append(item);
+    }
+
+    if (nLastRow > nFirstRow)
+        endInsertRows();
+}
+
+void    xSearchResultsModel::setResults(const xSearchResultList & results) {
+    emit layoutAboutToBeChanged();
+    m_results = results;
+    emit layoutChanged();
+}
+
+void    xSearchResultsModel::truncateAtPosition(quint64 position) {
+    qint64  nItem = m_results.lowerBound(position);
+    int     nRows = visibleRows(m_results.size());
+
+    if (nItem >= m_results.size())
+        return;
+
+    if (nItem >= nRows) {
+        m_results.truncate(nItem);
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), nItem, nRows - 1);
+    m_results.truncate(nItem);
+    endRemoveRows();
+}
+
+void    xSearchResultsModel::clear() {
+    emit layoutAboutToBeChanged();
+    m_results.clear();
+    emit layoutChanged();
+}
+
+qint64  xSearchResultsModel::lineNumber(int row) const {
+    return m_results.lineNumber(row);
+}
+
+searchResult    xSearchResultsModel::itemAt(int row) const {
+    return m_results.at(row);
+}
+
+quint64     xSearchResultsModel::memoryUsage() const {
+    return m_results.memoryUsage();
+}
+
+int     xSearchResultsModel::rowCount(const QModelIndex & parent) const {
+    Q_UNUSED(parent);
+    return visibleRows(m_results.size());
+}
@@ -0,0 +1,70 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xSearchResultsModel_h_
+#define _xSearchResultsModel_h_  1
+
+#include <limits>
+
+#include "xvaluelistmodel.h"
+#include "xsearchresultlist.h"
+
+// find results kept in compact xSearchResultList, row text is produced
+// by data callback when view asks for it
+
+class xSearchResultsModel : public xValueListModel {
+    Q_OBJECT
+public:
+
+    xSearchResultsModel(QObject * pParent = nullptr);
+    ~xSearchResultsModel();
+
+    void        appendItems(const searchResults & items);
+    void        setResults(const xSearchResultList & results);
+    void        truncateAtPosition(quint64 position);
+    void        clear();
+
+    const xSearchResultList &   results() const {
+        return m_results;
+    }
+
+    searchResult    itemAt(int row) const;
+    qint64          lineNumber(int row) const;
+
+    qint64          lastLineNumber() const {
+        return m_results.lastLineNumber();
+    }
+
+    quint64     memoryUsage() const;
+
+    virtual int      rowCount(const QModelIndex & parent = QModelIndex()) const override;
+
+protected:
+
+    static  int     visibleRows(qint64 nItems) {
+        return (int)qMin<qint64>(nItems, std::numeric_limits<int>::max());
+    }
+
+    xSearchResultList           m_results;
+};
+
+#endif
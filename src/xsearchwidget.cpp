@@ -64,11 +64,29 @@ xSearchWidget::xSearchWidget(QWidget * pParent) :
         onTextChanged(m_searchLine->currentText());
     });
 
+    m_expression = new QCheckBox(tr("Boolean expression (AND, OR, NOT, \"text\", /regexp/)"));
+    connect(m_expression, &QCheckBox::stateChanged, [this]() {
+        onTextChanged(m_searchLine->currentText());
+    });
+
 
     pLayout->addLayout(pSearchLayout);
     pLayout->addWidget(m_wholeWords);
     pLayout->addWidget(m_matchCase);
     pLayout->addWidget(m_regularExpression);
+    pLayout->addWidget(m_expression);
+
+    // reason why expression can not be used, hidden while it is fine
+
+    m_error = new QLabel();
+    m_error->setWordWrap(true);
+    m_error->hide();
+
+    QPalette errorPalette = m_error->palette();
+    errorPalette.setColor(QPalette::WindowText, Qt::darkRed);
+    m_error->setPalette(errorPalette);
+
+    pLayout->addWidget(m_error);
 
     connect(m_searchLine, &QComboBox::currentTextChanged, this, &xSearchWidget::onTextChanged);
     connect(m_searchLine, &QComboBox::editTextChanged, this, &xSearchWidget::onTextChanged);
@@ -113,9 +131,15 @@ xSearchWidget::~xSearchWidget() {
 
 }
 
-searchRequestItem   xSearchWidget::currentSearchItem(bool * bOk) const {
+searchRequestItem   xSearchWidget::currentSearchItem(bool * bOk, QString * pError) const {
     searchRequestItem   item;
 
+    if (m_expression->isChecked()) {
+        item = searchRequestItem::expressionSearch(m_searchLine->currentText(), pError);
+        *bOk = item.isValid();
+        return item;
+    }
+
     if (m_regularExpression->isChecked()) {
         item = searchRequestItem::regexpSearch(m_searchLine->currentText());
         if (!item.regexp.isValid() || item.regexp.pattern().isEmpty()) {
@@ -151,11 +175,17 @@ searchRequestItem   xSearchWidget::currentSearchItem(bool * bOk) const {
 }
 
 void xSearchWidget::onTextChanged(const QString & text) {
-    if (!isVisible() || (text.length() == 0))
+    if (!isVisible() || (text.length() == 0)) {
+        m_error->hide();
         return;
+    }
+
+    bool    bOk = false;
+    QString error;
+    searchRequestItem   item = currentSearchItem(&bOk, &error);
 
-    bool bOk = false;
-    searchRequestItem   item = currentSearchItem(&bOk);
+    m_error->setText(error);
+    m_error->setVisible(!error.isEmpty());
 
     if (bOk) {
         emit searchChanged(item);
@@ -30,6 +30,7 @@
 class xPlainTextViewer;
 class QCheckBox;
 class QComboBox;
+class QLabel;
 
 class xSearchWidget: public QWidget {
 	Q_OBJECT
@@ -38,7 +39,7 @@ public:
 	~xSearchWidget();
 
     void                setSearchText(const QString & text);
-    searchRequestItem   currentSearchItem(bool * bOk) const;
+    searchRequestItem   currentSearchItem(bool * bOk, QString * pError = nullptr) const;
 
 signals:
 
@@ -57,6 +58,8 @@ protected:
     QCheckBox        *  m_wholeWords;
     QCheckBox        *  m_matchCase;
     QCheckBox        *  m_regularExpression;
+    QCheckBox        *  m_expression;
+    QLabel           *  m_error;
 
 };
 
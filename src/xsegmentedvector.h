@@ -0,0 +1,160 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xSegmentedVector_h_
+#define _xSegmentedVector_h_  1
+
+#include <QVector>
+#include <QDataStream>
+
+// append only storage made of fixed size segments, appending never
+// relocates existing elements and copies share untouched segments,
+// element access stays O(1) by splitting index into segment and offset
+
+template <typename T, int SegmentShift = 16> class xSegmentedVector {
+public:
+
+    enum {
+        segmentSize = 1 << SegmentShift,
+        segmentMask = segmentSize - 1
+    };
+
+    qint64      size() const {
+        return m_size;
+    }
+
+    bool        isEmpty() const {
+        return m_size == 0;
+    }
+
+    void        clear() {
+        m_segments.clear();
+        m_size = 0;
+    }
+
+    void        append(const T & value) {
+        if ((m_size & segmentMask) == 0) {
+            m_segments << QVector<T>();
+            m_segments.last().reserve(segmentSize);
+        }
+
+        m_segments.last().append(value);
+        m_size++;
+    }
+
+    xSegmentedVector &  operator << (const T & value) {
+        append(value);
+        return *this;
+    }
+
+    const T &   at(qint64 index) const {
+        return m_segments.at(index >> SegmentShift).at(index & segmentMask);
+    }
+
+    const T &   operator[](qint64 index) const {
+        return at(index);
+    }
+
+    T &         operator[](qint64 index) {
+        return m_segments[index >> SegmentShift][index & segmentMask];
+    }
+
+    const T &   last() const {
+        return at(m_size - 1);
+    }
+
+    // elements are contiguous only up to the end of their segment
+
+    const T *   constData(qint64 index) const {
+        if (index >= m_size)
+            return nullptr;
+
+        return m_segments.at(index >> SegmentShift).constData() + (index & segmentMask);
+    }
+
+    qint64      remainingInSegment() const {
+        return (m_size & segmentMask) ? segmentSize - (m_size & segmentMask) : 0;
+    }
+
+    void        resize(qint64 size) {
+        if (size < 0)
+            size = 0;
+
+        if (size >= m_size) {
+            while (m_size < size) {
+                append(T());
+            }
+            return;
+        }
+
+        m_segments.resize((size + segmentMask) >> SegmentShift);
+        if (size & segmentMask) {
+            m_segments.last().resize(size & segmentMask);
+        }
+
+        m_size = size;
+    }
+
+    quint64     memoryUsage() const {
+        return (quint64)m_segments.size() * segmentSize * sizeof(T) + m_segments.capacity() * sizeof(QVector<T>);
+    }
+
+    // raw serialization, only for plain types
+
+    bool        writeRaw(QDataStream & stream) const {
+        for (const QVector<T> & segment : m_segments) {
+            stream.writeRawData((const char *)segment.constData(), segment.size() * sizeof(T));
+        }
+
+        return stream.status() == QDataStream::Ok;
+    }
+
+    bool        readRaw(QDataStream & stream, qint64 size) {
+        clear();
+
+        while (m_size < size) {
+            int nCount = qMin<qint64>(segmentSize, size - m_size);
+
+            QVector<T> segment;
+            segment.reserve(segmentSize);
+            segment.resize(nCount);
+
+            int nBytes = nCount * sizeof(T);
+            if (stream.readRawData((char *)segment.data(), nBytes) != nBytes) {
+                clear();
+                return false;
+            }
+
+            m_segments << segment;
+            m_size += nCount;
+        }
+
+        return true;
+    }
+
+protected:
+
+    QVector< QVector<T> >   m_segments;
+    qint64                  m_size = 0;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xSpscQueue_h_
+#define _xSpscQueue_h_  1
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
+// unbounded single producer / single consumer queue of segments,
+// producer only touches tail and consumer only touches head, they meet
+// through atomic next pointer so no locks are needed on either side
+
+template <typename T> class xSpscQueue {
+public:
+
+    xSpscQueue() {
+        m_head = new node();
+        m_tail = m_head;
+    }
+
+    ~xSpscQueue() {
+        while (m_head) {
+            node * pNext = m_head->next.loadAcquire();
+            delete m_head;
+            m_head = pNext;
+        }
+    }
+
+    // producer side, returns true if consumer has to be notified,
+    // until consumer acknowledges following pushes do not notify again
+
+    bool        push(T && value) {
+        node * pNode = new node();
+        pNode->value = std::move(value);
+
+        m_tail->next.storeRelease(pNode);
+        m_tail = pNode;
+
+        return m_notify.testAndSetOrdered(0, 1);
+    }
+
+    // consumer side
+
+    bool        pop(T & value) {
+        node * pNext = m_head->next.loadAcquire();
+        if (!pNext)
+            return false;
+
+        value = std::move(pNext->value);
+        delete m_head;
+        m_head = pNext;
+
+        return true;
+    }
+
+    void        acknowledge() {
+        m_notify.storeRelease(0);
+    }
+
+    void        clear() {
+        T value;
+        while (pop(value));
+    }
+
+protected:
+
+    struct node {
+        T                       value;
+        QAtomicPointer<node>    next;
+    };
+
+    node        *   m_head      = nullptr;
+    node        *   m_tail      = nullptr;
+    QAtomicInt      m_notify    = 0;
+
+private:
+    Q_DISABLE_COPY(xSpscQueue)
+};
+
+#endif
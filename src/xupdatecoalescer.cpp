@@ -0,0 +1,103 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QTimerEvent>
+
+#include "xupdatecoalescer.h"
+
+xUpdateCoalescer::xUpdateCoalescer(int interval, QObject * pParent):
+    QObject(pParent),
+    m_interval(interval) {
+}
+
+xUpdateCoalescer::~xUpdateCoalescer() {
+}
+
+void    xUpdateCoalescer::requestLayout() {
+    m_bLayoutPending  = true;
+    m_appendFirstLine = -1;
+    m_appendCount     = 0;
+
+    schedule();
+}
+
+void    xUpdateCoalescer::requestAppend(qint64 firstLine, qint64 count) {
+    if (count <= 0)
+        return;
+
+    if (!m_bLayoutPending) {
+        if (m_appendFirstLine < 0) {
+            m_appendFirstLine = firstLine;
+            m_appendCount     = count;
+        }
+        else {
+            // lines from firstLine are replaced by latest request,
+            // so merged range starts at lowest line and ends with latest tail
+
+            qint64 nEnd       = firstLine + count;
+            m_appendFirstLine = qMin(m_appendFirstLine, firstLine);
+            m_appendCount     = nEnd - m_appendFirstLine;
+        }
+    }
+
+    schedule();
+}
+
+bool    xUpdateCoalescer::isPending() const {
+    return m_bLayoutPending || (m_appendFirstLine >= 0);
+}
+
+void    xUpdateCoalescer::schedule() {
+    if (m_timer != -1)
+        return;
+
+    qint64 nElapsed = m_lastFlush.isValid() ? m_lastFlush.elapsed() : m_interval;
+    m_timer = startTimer(qMax<qint64>(0, m_interval - nElapsed));
+}
+
+void    xUpdateCoalescer::flush() {
+    if (m_timer != -1) {
+        killTimer(m_timer);
+        m_timer = -1;
+    }
+
+    m_lastFlush.start();
+
+    if (m_bLayoutPending) {
+        m_bLayoutPending = false;
+        emit layoutChanged();
+    }
+    else if (m_appendFirstLine >= 0) {
+        qint64 firstLine  = m_appendFirstLine;
+        qint64 count      = m_appendCount;
+
+        m_appendFirstLine = -1;
+        m_appendCount     = 0;
+
+        emit linesAppended(firstLine, count);
+    }
+}
+
+void    xUpdateCoalescer::timerEvent(QTimerEvent * pEvent) {
+    if (pEvent->timerId() == m_timer) {
+        flush();
+    }
+}
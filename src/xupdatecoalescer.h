@@ -0,0 +1,71 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+
+#ifndef _xUpdateCoalescer_h_
+#define _xUpdateCoalescer_h_  1
+
+#include <QObject>
+#include <QElapsedTimer>
+
+// merges document change notifications into at most one per interval,
+// plain appends are reported separately so views can skip full relayout
+
+class xUpdateCoalescer : public QObject {
+    Q_OBJECT
+public:
+
+    xUpdateCoalescer(int interval = 16, QObject * pParent = nullptr);
+    ~xUpdateCoalescer();
+
+    void    requestLayout();
+    void    requestAppend(qint64 firstLine, qint64 count);
+
+    void    flush();
+    bool    isPending() const;
+
+signals:
+
+    void    layoutChanged();
+
+    // lines starting from firstLine were appended or replaced,
+    // everything before firstLine is untouched
+
+    void    linesAppended(qint64 firstLine, qint64 count);
+
+protected:
+
+    void    schedule();
+
+    virtual void    timerEvent(QTimerEvent * pEvent) override;
+
+protected:
+
+    int             m_interval          = 16;
+    int             m_timer             = -1;
+    QElapsedTimer   m_lastFlush;
+
+    bool            m_bLayoutPending    = false;
+    qint64          m_appendFirstLine   = -1;
+    qint64          m_appendCount       = 0;
+};
+
+#endif
@@ -30,3 +30,59 @@ xValueListModel::~xValueListModel() {
 
 };
 
+void    xValueListModel::setDataCallback(DataFunction f, int role) {
+    funcDataCallbacks[role] = f;
+}
+
+void    xValueListModel::setHeaderCallback(HeaderFunction f, int role) {
+    funcHeaderCallbacks[role] = f;
+}
+
+void    xValueListModel::setFlagsCallback(FlagsFunction f) {
+    funcFlags = f;
+}
+
+void    xValueListModel::setColumnCount(int cnt) {
+    m_columnCount = cnt;
+}
+
+int     xValueListModel::columnCount(const QModelIndex &parent) const {
+    Q_UNUSED(parent);
+    return m_columnCount;
+}
+
+QVariant    xValueListModel::data(const QModelIndex &index, int role) const {
+    if ((index.row() >= rowCount()) || (index.column() >= columnCount()))
+        return QVariant();
+
+    if (funcDataCallbacks.contains(role)) {
+        return funcDataCallbacks[role](index.row(), index.column(), role);
+    } else if (funcDataCallbacks.contains(-1)) {
+        return funcDataCallbacks[-1](index.row(), index.column(), role);
+    }
+
+    return QVariant();
+}
+
+QVariant    xValueListModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (funcHeaderCallbacks.contains(role)) {
+        return funcHeaderCallbacks[role](section, orientation, role);
+    }
+    else if (funcHeaderCallbacks.contains(-1)) {
+        return funcHeaderCallbacks[-1](section, orientation, role);
+    }
+
+    return QVariant();
+}
+
+Qt::ItemFlags   xValueListModel::flags(const QModelIndex &index) const {
+    Qt::ItemFlags defaultFlags = QAbstractTableModel::flags(index);
+
+    if ((index.row() >= rowCount()) || (index.column() >= columnCount()))
+        return defaultFlags;
+
+    if (funcFlags)
+        return funcFlags(index.row(), index.column(), defaultFlags);
+
+    return defaultFlags;
+}
@@ -25,17 +25,36 @@
 #include <QObject>
 #include <QAbstractTableModel>
 
+typedef std::function<QVariant( int /*row*/,int /*column*/, int /*role*/)> DataFunction;
+typedef std::function<Qt::ItemFlags(int /*row*/, int /*column*/, Qt::ItemFlags /*flags*/)> FlagsFunction;
+typedef std::function<QVariant( int /*section*/, Qt::Orientation /*orientation*/, int /*role*/)> HeaderFunction;
+
+// cells, headers and flags are produced by callbacks, derived models
+// only provide storage and row count
+
 class xValueListModel : public QAbstractTableModel {
     Q_OBJECT
 public:
     xValueListModel(QObject *pParent = nullptr);
     ~xValueListModel();
 
-};
+    void        setDataCallback(DataFunction f, int role = -1);
+    void        setHeaderCallback(HeaderFunction f, int role = -1);
+    void        setFlagsCallback(FlagsFunction f);
+    void        setColumnCount(int cnt);
 
-typedef std::function<QVariant( int /*row*/,int /*column*/, int /*role*/)> DataFunction;
-typedef std::function<Qt::ItemFlags(int /*row*/, int /*column*/, Qt::ItemFlags /*flags*/)> FlagsFunction;
-typedef std::function<QVariant( int /*section*/, Qt::Orientation /*orientation*/, int /*role*/)> HeaderFunction;
+    virtual int      columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    virtual Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+protected:
+    int                         m_columnCount   = 0;
+
+    QMap<int, DataFunction>     funcDataCallbacks;
+    QMap<int, HeaderFunction>   funcHeaderCallbacks;
+    FlagsFunction               funcFlags = nullptr;
+};
 
 template <typename T> class xValueCollection: public xValueListModel {
 public:
@@ -111,69 +130,11 @@ public:
         emit layoutChanged();
     }
 
-    void        setDataCallback(DataFunction f, int role = -1) {
-        funcDataCallbacks[role] = f;
-    }
-
-    void        setHeaderCallback(HeaderFunction f, int role = -1) {
-        funcHeaderCallbacks[role] = f;
-    }
-
-    void        setFlagsCallback(FlagsFunction f) {
-        funcFlags = f;
-    }
-
-    void        setColumntCount(int cnt) {
-        m_columnCount = cnt;
-    }
-        
     virtual int      rowCount(const QModelIndex &parent = QModelIndex()) const override {
         Q_UNUSED(parent);
         return m_items.count();
     }
 
-    virtual int      columnCount(const QModelIndex &parent = QModelIndex()) const override {
-        Q_UNUSED(parent);       
-        return m_columnCount;
-    }
-
-    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
-        if ((index.row() >= rowCount()) || (index.column() >= columnCount()))
-            return QVariant();
-
-        if (funcDataCallbacks.contains(role)) {
-            return funcDataCallbacks[role](index.row(), index.column(), role);
-        } else if (funcDataCallbacks.contains(-1)) {
-            return funcDataCallbacks[-1](index.row(), index.column(), role);
-        }
-
-        return QVariant();
-    }
-
-    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
-    
-        if (funcHeaderCallbacks.contains(role)) {
-            return funcHeaderCallbacks[role](section, orientation, role);
-        }
-        else if (funcHeaderCallbacks.contains(-1)) {
-            return funcHeaderCallbacks[-1](section, orientation, role);
-        }
-
-        return QVariant();
-    }
-
-    virtual Qt::ItemFlags flags(const QModelIndex &index) const override {
-        Qt::ItemFlags defaultFlags = QAbstractTableModel::flags(index);
-
-        if ((index.row() >= rowCount()) || (index.column() >= columnCount()))
-            return defaultFlags;
-    
-        if (funcFlags)
-            return funcFlags(index.row(), index.column(), defaultFlags);
-        
-        return defaultFlags;
-    }
-
     const T &   itemAt(int row) {
         if (row >= m_items.size())
             return m_emptyValue;
@@ -188,11 +149,6 @@ public:
 protected:
     const T                     m_emptyValue;
     QVector<T>                  m_items;
-    int                         m_columnCount   = 0;
-
-    QMap<int, DataFunction>     funcDataCallbacks;
-    QMap<int, HeaderFunction>   funcHeaderCallbacks;
-    FlagsFunction               funcFlags = nullptr;
 };
 
 
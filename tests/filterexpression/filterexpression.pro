@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET 	 = tst_filterexpression
+
+QT 	+= testlib network concurrent core widgets
+
+CONFIG += testcase console
+CONFIG -= app_bundle
+
+include(../../src/sources.pri)
+
+SOURCES += ./tst_filterexpression.cpp
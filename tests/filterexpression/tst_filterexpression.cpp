@@ -0,0 +1,207 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QtTest>
+#include <QTextCodec>
+
+#include "xdocument.h"
+#include "xfilterexpression.h"
+#include "xfilterplan.h"
+
+// plan with access to order of children of its root step
+
+class xFilterPlanProbe : public xFilterPlan {
+public:
+
+    xFilterPlanProbe(const filterRules & rules, QTextCodec * pCodec):
+        xFilterPlan(rules, pCodec) {
+    }
+
+    QStringList     rootOrder() const {
+        QStringList order;
+        for (int nChild : m_steps.at(m_root).children) {
+            const step & s = m_steps.at(nChild);
+            order << ((s.type == stepRegExp) ? s.request.regexp.pattern() : s.request.matcher.pattern());
+        }
+        return order;
+    }
+
+    static  int     reorderInterval() {
+        return m_reorderInterval;
+    }
+};
+
+class tst_FilterExpression : public QObject {
+    Q_OBJECT
+
+private slots:
+
+    void    parse_data();
+    void    parse();
+    void    errors_data();
+    void    errors();
+    void    nestingDepth();
+
+    void    planMatchesExpression();
+    void    planOrdersByCost();
+    void    planReordersBySelectivity();
+
+protected:
+
+    static  filterRule  rule(const searchRequestItem & item);
+    static  bool        planMatches(xFilterPlan & plan, const QByteArray & line);
+};
+
+filterRule  tst_FilterExpression::rule(const searchRequestItem & item) {
+    filterRule  r;
+    r.filter   = item;
+    r.isActive = true;
+    return r;
+}
+
+bool    tst_FilterExpression::planMatches(xFilterPlan & plan, const QByteArray & line) {
+    QString text;
+    return plan.matches(line.constData(), line.size(), text);
+}
+
+void    tst_FilterExpression::parse_data() {
+    QTest::addColumn<QString>("expression");
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<bool>("matched");
+
+    QTest::newRow("word")               << "error"                  << "an error here"          << true;
+    QTest::newRow("adjacent and")       << "error disk"             << "disk error"             << true;
+    QTest::newRow("adjacent and fails") << "error disk"             << "error"                  << false;
+    QTest::newRow("or")                 << "error OR warning"       << "a warning"              << true;
+    QTest::newRow("not")                << "error NOT disk"         << "error on disk"          << false;
+    QTest::newRow("parentheses")        << "(a OR b) && c"          << "b c"                    << true;
+    QTest::newRow("quoted case")        << "\"Error\""              << "error"                  << false;
+    QTest::newRow("quoted flag")        << "\"Error\"i"             << "error"                  << true;
+    QTest::newRow("flag before paren")  << "(\"Error\"i)"           << "ERROR"                  << true;
+    QTest::newRow("i starts word")      << "\"abc\"ignore"          << "abc ignore"             << true;
+    QTest::newRow("i not flag")         << "\"abc\"ignore"          << "ABC gnore"              << false;
+    QTest::newRow("regexp")             << "/err(or)?\\d+/"         << "error42"                << true;
+    QTest::newRow("regexp flag")        << "/err\\d+/i"             << "ERR7"                   << true;
+    QTest::newRow("path word")          << "/var/log/app"           << "open /var/log/app"      << true;
+    QTest::newRow("path word only")     << "/var/log/app"           << "var"                    << false;
+    QTest::newRow("quote inside word")  << "ab\"cd"                 << "xab\"cdx"               << true;
+}
+
+void    tst_FilterExpression::parse() {
+    QFETCH(QString, expression);
+    QFETCH(QString, line);
+    QFETCH(bool, matched);
+
+    xFilterExpression   compiled;
+    QVERIFY2(compiled.parse(expression), qPrintable(compiled.errorString()));
+    QCOMPARE(compiled.matches(line), matched);
+}
+
+void    tst_FilterExpression::errors_data() {
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("empty")              << "";
+    QTest::newRow("open quote")         << "\"abc";
+    QTest::newRow("empty quote")        << "\"\"";
+    QTest::newRow("open parenthesis")   << "(a OR b";
+    QTest::newRow("dangling or")        << "a OR";
+    QTest::newRow("close only")         << ")";
+    QTest::newRow("bad regexp")         << "/a(/";
+}
+
+void    tst_FilterExpression::errors() {
+    QFETCH(QString, expression);
+
+    QString             error;
+    searchRequestItem   item = searchRequestItem::expressionSearch(expression, &error);
+
+    QVERIFY(!item.isValid());
+    QVERIFY(!error.isEmpty());
+}
+
+void    tst_FilterExpression::nestingDepth() {
+    xFilterExpression   compiled;
+
+    QVERIFY(compiled.parse(QString(32, '(') + "a" + QString(32, ')')));
+    QVERIFY(compiled.matches("a"));
+
+    QVERIFY(!compiled.parse(QString(100000, '!') + "a"));
+    QVERIFY(!compiled.errorString().isEmpty());
+
+    QVERIFY(!compiled.parse(QString(100000, '(') + "a" + QString(100000, ')')));
+    QVERIFY(!compiled.errorString().isEmpty());
+}
+
+void    tst_FilterExpression::planMatchesExpression() {
+    QTextCodec *        pCodec = QTextCodec::codecForName("UTF-8");
+    searchRequestItem   item   = searchRequestItem::expressionSearch("(\"Disk\"i OR /net\\d/) NOT timeout");
+    QVERIFY(item.isValid());
+
+    xFilterPlan plan(item, pCodec);
+
+    QVERIFY(planMatches(plan, "DISK full\n"));
+    QVERIFY(planMatches(plan, "net0 down\n"));
+    QVERIFY(!planMatches(plan, "net0 timeout\n"));
+    QVERIFY(!planMatches(plan, "cpu\n"));
+}
+
+void    tst_FilterExpression::planOrdersByCost() {
+    QTextCodec *    pCodec = QTextCodec::codecForName("UTF-8");
+    filterRules     rules;
+
+    rules << rule(searchRequestItem::regexpSearch("err\\d+"));
+    rules << rule(searchRequestItem::patternSearch("disk"));
+
+    // literal checked on raw bytes is cheaper than regexp, it goes first
+
+    xFilterPlanProbe    plan(rules, pCodec);
+    QCOMPARE(plan.rootOrder(), QStringList() << "disk" << "err\\d+");
+
+    QVERIFY(planMatches(plan, "disk err42\n"));
+    QVERIFY(!planMatches(plan, "disk\n"));
+}
+
+void    tst_FilterExpression::planReordersBySelectivity() {
+    QTextCodec *    pCodec = QTextCodec::codecForName("UTF-8");
+    filterRules     rules;
+
+    rules << rule(searchRequestItem::patternSearch("common"));
+    rules << rule(searchRequestItem::patternSearch("rare"));
+
+    xFilterPlanProbe    plan(rules, pCodec);
+    QCOMPARE(plan.rootOrder(), QStringList() << "common" << "rare");
+
+    // rule failing most often decides AND soonest, it moves to front,
+    // results stay the same
+
+    for (int i = 0; i < xFilterPlanProbe::reorderInterval(); i++) {
+        QVERIFY(!planMatches(plan, "common line\n"));
+    }
+
+    QCOMPARE(plan.rootOrder(), QStringList() << "rare" << "common");
+
+    QVERIFY(planMatches(plan, "common rare\n"));
+    QVERIFY(!planMatches(plan, "rare\n"));
+}
+
+QTEST_MAIN(tst_FilterExpression)
+
+#include "tst_filterexpression.moc"
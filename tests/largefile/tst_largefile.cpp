@@ -0,0 +1,340 @@
+/**
+ *  Copyright 2020 by Yuri Alexandrov <evilruff@gmail.com>
+ *
+ * This file is part of some open source application.
+ *
+ * Some open source application is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Some open source application is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QLogView.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QDataStream>
+#include <QBuffer>
+
+#include "xdocument.h"
+#include "xfileprocessor.h"
+#include "xlineindex.h"
+#include "xscrollbar.h"
+#include "xsysteminformation.h"
+
+// files used here are far beyond 32 bit limits, file of 4+ GB is created
+// sparse, so it takes almost no disk space; index of more than 2^31 lines
+// is built in memory from synthetic lines, file with that many lines can not
+// be sparse, newlines have to be written, so it is only created when
+// QLOGVIEW_LARGE_TESTS environment variable is set
+
+// document with indexes set directly, no file is read
+
+class xDocumentProbe : public xDocument {
+public:
+
+    void    setIndexes(const xLineIndex & index, const xFilterIndex & filter, bool bFilterActive) {
+        m_fileIndex     = index;
+        m_filterIndex   = filter;
+        m_bFilterActive = bFilterActive;
+    }
+};
+
+class tst_LargeFile : public QObject {
+    Q_OBJECT
+
+private slots:
+
+    void    initTestCase();
+    void    cleanupTestCase();
+
+    void    scrollBarLogicalRange();
+    void    lineIndexBeyond4GB();
+    void    sparseFileBeyond4GB();
+    void    moreThan2Pow31Lines();
+    void    searchBeyond2Pow31Lines();
+
+protected:
+
+    bool        createSparseFile(const QString & fileName, quint64 size, const QVector<quint64> & newlines);
+    linesData   indexFile(const QString & fileName);
+    searchResults   searchFile(const QString & fileName, const QString & pattern);
+
+protected:
+
+    QTemporaryDir       m_dir;
+    xFileProcessor  *   m_processor = nullptr;
+
+    const int           m_timeout   = 30 * 60 * 1000;
+};
+
+void    tst_LargeFile::initTestCase() {
+    qRegisterMetaType<searchRequestItem>();
+    qRegisterMetaType<searchRange>();
+
+    QVERIFY(m_dir.isValid());
+
+    m_processor = new xFileProcessor();
+    m_processor->activate();
+}
+
+void    tst_LargeFile::cleanupTestCase() {
+    m_processor->shutdown();
+}
+
+bool    tst_LargeFile::createSparseFile(const QString & fileName, quint64 size, const QVector<quint64> & newlines) {
+    QFile   f(fileName);
+    if (!f.open(QIODevice::WriteOnly) || !f.resize(size))
+        return false;
+
+    for (quint64 position : newlines) {
+        if (!f.seek(position) || !f.putChar('\n'))
+            return false;
+    }
+
+    return true;
+}
+
+linesData   tst_LargeFile::indexFile(const QString & fileName) {
+    QMetaObject::invokeMethod(m_processor, "createIndex", Qt::QueuedConnection,
+        Q_ARG(QString, fileName),
+        Q_ARG(quint64, 0),
+        Q_ARG(int, 10000),
+        Q_ARG(int, 1024 * 1024));
+
+    linesData       lines;
+    indexBatch      batch;
+    QElapsedTimer   et;
+    et.start();
+
+    while (et.elapsed() < m_timeout) {
+        while (m_processor->indexQueue()->pop(batch)) {
+            lines << batch.data;
+            if (batch.bCompleted)
+                return lines;
+        }
+
+        QTest::qWait(10);
+    }
+
+    return linesData();
+}
+
+searchResults   tst_LargeFile::searchFile(const QString & fileName, const QString & pattern) {
+    QMetaObject::invokeMethod(m_processor, "searchData", Qt::QueuedConnection,
+        Q_ARG(QString, fileName),
+        Q_ARG(QByteArray, QByteArray("UTF-8")),
+        Q_ARG(searchRequestItem, searchRequestItem::patternSearch(pattern)),
+        Q_ARG(searchRange, searchRange()),
+        Q_ARG(int, 0),
+        Q_ARG(int, 10000),
+        Q_ARG(int, 1024 * 1024));
+
+    searchResults   results;
+    searchBatch     batch;
+    QElapsedTimer   et;
+    et.start();
+
+    while (et.elapsed() < m_timeout) {
+        while (m_processor->searchQueue()->pop(batch)) {
+            results << batch.data;
+            if (batch.bCompleted)
+                return results;
+        }
+
+        QTest::qWait(10);
+    }
+
+    return searchResults();
+}
+
+void    tst_LargeFile::scrollBarLogicalRange() {
+    xScrollBar  scrollBar(nullptr);
+
+    const qint64 nMaximum = Q_INT64_C(5000000000);
+
+    scrollBar.setLogicalMaximum(nMaximum);
+    QCOMPARE(scrollBar.logicalMaximum(), nMaximum);
+    QVERIFY(scrollBar.maximum() > 0);
+
+    scrollBar.setLogicalValue(nMaximum - 1);
+    QCOMPARE(scrollBar.logicalValue(), nMaximum - 1);
+
+    scrollBar.setLogicalValue(nMaximum * 2);
+    QCOMPARE(scrollBar.logicalValue(), nMaximum);
+}
+
+void    tst_LargeFile::lineIndexBeyond4GB() {
+    const quint64   nStart = Q_UINT64_C(5) << 30;
+    const int       nLines = 100000;
+
+    xLineIndex  index;
+    for (int i = 0; i < nLines; i++) {
+        index.append(nStart + (quint64)i * 100, 100);
+    }
+
+    QCOMPARE(index.size(), (qint64)nLines);
+    QCOMPARE(index.position(nLines - 1), nStart + (quint64)(nLines - 1) * 100);
+    QCOMPARE(index.lineByPosition(nStart + 12345 * 100 + 50), (qint64)12345);
+
+    // cached index keeps 64 bit positions
+
+    QBuffer     buffer;
+    buffer.open(QIODevice::ReadWrite);
+
+    QDataStream out(&buffer);
+    QVERIFY(index.write(out));
+
+    buffer.seek(0);
+
+    QDataStream in(&buffer);
+    xLineIndex  restored;
+    QVERIFY(restored.read(in));
+
+    QCOMPARE(restored.size(), index.size());
+    QCOMPARE(restored.position(nLines / 2), index.position(nLines / 2));
+    QCOMPARE(restored.lastPosition(), index.lastPosition());
+}
+
+void    tst_LargeFile::sparseFileBeyond4GB() {
+    const quint64   nSize   = Q_UINT64_C(5) << 30;
+    const quint64   nStride = Q_UINT64_C(64) << 20;
+    const quint64   nNeedle = 72 * nStride;
+
+    // lines of 64 MB of zeroes, needle line starts at 4.5 GB
+
+    QString             fileName = m_dir.filePath("sparse.log");
+    QVector<quint64>    newlines;
+
+    for (quint64 position = nStride; position < nSize; position += nStride) {
+        newlines << position;
+    }
+
+    if (!createSparseFile(fileName, nSize, newlines))
+        QSKIP("file system does not support large sparse files");
+
+    QFile   f(fileName);
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    QVERIFY(f.seek(nNeedle + 1));
+    QVERIFY(f.write("needle\n") == 7);
+    f.close();
+
+    linesData   lines = indexFile(fileName);
+
+    QCOMPARE(lines.size(), newlines.size() + 2);
+    QCOMPARE(lines[72].position, nNeedle + 1);
+    QCOMPARE(lines[73].position, nNeedle + 8);
+    QCOMPARE(lines.last().position, newlines.last() + 1);
+    QCOMPARE(lines.last().position + lines.last().length, nSize);
+
+    searchResults   results = searchFile(fileName, "needle");
+
+    QCOMPARE(results.size(), 1);
+    QCOMPARE(results.first().position, nNeedle + 1);
+    QCOMPARE(results.first().lineNumber, (qint64)72);
+
+    QFile::remove(fileName);
+}
+
+void    tst_LargeFile::moreThan2Pow31Lines() {
+
+    // index takes little more than byte per line, filter index about
+    // quarter of byte per source line
+
+    if (xSystemInformation::getTotalMemorySize() < 8 * 1024)
+        QSKIP("index of more than 2^31 lines needs at least 8 GB of memory");
+
+    const qint64    nLines  = (Q_INT64_C(1) << 31) + 16;
+    const int       nLength = 3;
+
+    xLineIndex  index;
+    for (qint64 i = 0; i < nLines; i++) {
+        index.append((quint64)i * nLength, nLength);
+    }
+
+    const qint64    nLast     = nLines - 1;
+    const quint64   nLastPos  = (quint64)nLast * nLength;
+
+    QCOMPARE(index.size(), nLines);
+    QCOMPARE(index.position(nLast), nLastPos);
+    QCOMPARE(index.length(nLast), nLength);
+    QCOMPARE(index.lineByPosition(nLastPos + 1), nLast);
+    QCOMPARE(index.lineByPosition((quint64)(Q_INT64_C(1) << 31) * nLength), Q_INT64_C(1) << 31);
+
+    // filter passes few lines on both sides of 2^31
+
+    QVector<qint64> passed;
+    passed << 7 << (Q_INT64_C(1) << 31) - 1 << (Q_INT64_C(1) << 31) << (Q_INT64_C(1) << 31) + 9 << nLast;
+
+    xFilterIndex    filter;
+    for (qint64 nLine : passed) {
+        filter.append(nLine);
+    }
+
+    xDocumentProbe  document;
+
+    document.setIndexes(index, filter, false);
+
+    QCOMPARE(document.logicalLinesCount(), nLines);
+    QCOMPARE(document.logicalToSourceLineNumber(nLast), nLast);
+    QCOMPARE(document.logicalLineStart(nLast), nLastPos);
+    QCOMPARE(document.logicalLineEnd(nLast), nLastPos + nLength - 1);
+    QCOMPARE(document.logicalLineByPosition(nLastPos), nLast);
+
+    document.setIndexes(index, filter, true);
+
+    QCOMPARE(document.logicalLinesCount(), (qint64)passed.size());
+
+    for (int i = 0; i < passed.size(); i++) {
+        qint64 nSource = passed.at(i);
+
+        QCOMPARE(document.logicalToSourceLineNumber(i), nSource);
+        QCOMPARE(document.sourceToLogicalLineNumber(nSource), (qint64)i);
+        QCOMPARE(document.logicalLineStart(i), (quint64)nSource * nLength);
+        QCOMPARE(document.logicalLineByPosition((quint64)nSource * nLength + 2), (qint64)i);
+    }
+
+    QCOMPARE(document.sourceToLogicalLineNumber((Q_INT64_C(1) << 31) + 1), Q_INT64_C(-1));
+}
+
+void    tst_LargeFile::searchBeyond2Pow31Lines() {
+    if (qEnvironmentVariableIsEmpty("QLOGVIEW_LARGE_TESTS"))
+        QSKIP("set QLOGVIEW_LARGE_TESTS to run test on file with more than 2^31 lines");
+
+    const quint64   nLines = (Q_UINT64_C(1) << 31) + 16;
+    const int       nBlock = 64 * 1024 * 1024;
+
+    QString     fileName = m_dir.filePath("lines.log");
+    QFile       f(fileName);
+    QVERIFY(f.open(QIODevice::WriteOnly));
+
+    QByteArray  block(nBlock, '\n');
+    for (quint64 nWritten = 0; nWritten < nLines; nWritten += nBlock) {
+        qint64 nPart = qMin<quint64>(nBlock, nLines - nWritten);
+        if (f.write(block.constData(), nPart) != nPart)
+            QSKIP("not enough disk space");
+    }
+
+    QVERIFY(f.write("needle\n") == 7);
+    f.close();
+
+    searchResults   results = searchFile(fileName, "needle");
+
+    QCOMPARE(results.size(), 1);
+    QCOMPARE(results.first().lineNumber, (qint64)nLines);
+    QCOMPARE(results.first().position, nLines);
+
+    QFile::remove(fileName);
+}
+
+QTEST_MAIN(tst_LargeFile)
+
+#include "tst_largefile.moc"